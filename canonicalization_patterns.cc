@@ -1,13 +1,18 @@
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/IR/UseDefLists.h"
 #include "mlir/IR/Value.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Support/LogicalResult.h"
 #include "sair_attributes.h"
 #include "sair_op_interfaces.h"
@@ -398,6 +403,109 @@ class NormalizeSequenceNumbers : public mlir::OpRewritePattern<SairProgramOp> {
   }
 };
 
+// Hashing and equality of Sair operations for common subexpression
+// elimination. Operations are equal if they have the same name, operands,
+// attributes, result types and bodies. Attributes include the mapping array
+// and lowering decisions.
+struct SairOperationInfo : public llvm::DenseMapInfo<mlir::Operation *> {
+  static unsigned getHashValue(const mlir::Operation *const_op) {
+    auto *op = const_cast<mlir::Operation *>(const_op);
+    llvm::hash_code hash = mlir::OperationEquivalence::computeHash(
+        op, mlir::OperationEquivalence::directHashValue,
+        mlir::OperationEquivalence::ignoreHashValue,
+        mlir::OperationEquivalence::IgnoreLocations);
+    // Only hash the operation names of bodies to keep hashing cheap. Bodies
+    // are fully compared by isEqual.
+    for (mlir::Region &region : op->getRegions()) {
+      region.walk([&](mlir::Operation *nested_op) {
+        hash = llvm::hash_combine(hash, nested_op->getName());
+      });
+    }
+    return hash;
+  }
+
+  static bool isEqual(const mlir::Operation *const_lhs,
+                      const mlir::Operation *const_rhs) {
+    if (const_lhs == const_rhs) return true;
+    if (const_lhs == getEmptyKey() || const_lhs == getTombstoneKey() ||
+        const_rhs == getEmptyKey() || const_rhs == getTombstoneKey()) {
+      return false;
+    }
+    return mlir::OperationEquivalence::isEquivalentTo(
+        const_cast<mlir::Operation *>(const_lhs),
+        const_cast<mlir::Operation *>(const_rhs),
+        mlir::OperationEquivalence::IgnoreLocations);
+  }
+};
+
+// Returns the memref a Sair value holding a memref refers to, or the Sair
+// value itself if the memref is not known. This only looks through
+// sair.from_scalar: memrefs computed inside the program are identified by the
+// Sair value holding them and may alias any other memref.
+mlir::Value UnderlyingMemRef(mlir::Value value) {
+  if (auto from_scalar = value.getDefiningOp<SairFromScalarOp>()) {
+    return from_scalar.getValue();
+  }
+  return value;
+}
+
+// Indicates if `op` is a sair.map, sair.copy or sair.from_memref operation that
+// can be merged with an identical operation. Maps must have side-effect free
+// bodies and memrefs read by sair.from_memref must not be written in the
+// program.
+bool IsCseCandidate(mlir::Operation *op,
+                    const llvm::DenseSet<mlir::Value> &written_memrefs) {
+  if (auto map_op = dyn_cast<SairMapOp>(op)) {
+    return llvm::all_of(map_op.block().without_terminator(),
+                        [](mlir::Operation &body_op) {
+                          return mlir::isMemoryEffectFree(&body_op);
+                        });
+  }
+  if (auto from_memref = dyn_cast<SairFromMemRefOp>(op)) {
+    mlir::Value memref = UnderlyingMemRef(from_memref.getMemref());
+    // Memrefs that are not imported with sair.from_scalar may alias written
+    // memrefs.
+    if (memref == from_memref.getMemref()) return written_memrefs.empty();
+    return !written_memrefs.contains(memref);
+  }
+  return isa<SairCopyOp>(op);
+}
+
+// Canonicalization pattern that merges structurally identical sair.map,
+// sair.copy and sair.from_memref operations of a sair.program operation. Only
+// operations with the same domain, inputs, mappings and bodies are merged, the
+// later one being replaced by the earlier one.
+class EliminateCommonSubexpressions
+    : public mlir::OpRewritePattern<SairProgramOp> {
+ public:
+  using mlir::OpRewritePattern<SairProgramOp>::OpRewritePattern;
+
+  mlir::LogicalResult matchAndRewrite(
+      SairProgramOp op, mlir::PatternRewriter &rewriter) const override {
+    llvm::DenseSet<mlir::Value> written_memrefs;
+    op.walk([&](mlir::Operation *nested_op) {
+      if (auto to_memref = dyn_cast<SairToMemRefOp>(nested_op)) {
+        written_memrefs.insert(UnderlyingMemRef(to_memref.getMemref()));
+      } else if (auto store = dyn_cast<SairStoreToMemRefOp>(nested_op)) {
+        written_memrefs.insert(UnderlyingMemRef(store.getMemref()));
+      }
+    });
+
+    llvm::DenseMap<mlir::Operation *, mlir::Operation *, SairOperationInfo>
+        known_ops;
+    bool changed = false;
+    for (mlir::Operation &nested_op :
+         llvm::make_early_inc_range(op.getBody().front())) {
+      if (!IsCseCandidate(&nested_op, written_memrefs)) continue;
+      auto [it, inserted] = known_ops.try_emplace(&nested_op, &nested_op);
+      if (inserted) continue;
+      rewriter.replaceOp(&nested_op, it->second->getResults());
+      changed = true;
+    }
+    return mlir::success(changed);
+  }
+};
+
 }  // end namespace
 
 void SairCopyOp::getCanonicalizationPatterns(mlir::RewritePatternSet &patterns,
@@ -491,7 +599,8 @@ void SairFreeOp::getCanonicalizationPatterns(mlir::RewritePatternSet &patterns,
 
 void SairProgramOp::getCanonicalizationPatterns(
     mlir::RewritePatternSet &patterns, mlir::MLIRContext *context) {
-  patterns.add<NormalizeSequenceNumbers>(context);
+  patterns.add<NormalizeSequenceNumbers, EliminateCommonSubexpressions>(
+      context);
 }
 
 }  // namespace sair
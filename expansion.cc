@@ -14,6 +14,10 @@
 
 #include "expansion.h"
 
+#include <algorithm>
+#include <optional>
+
+#include "llvm/Support/MathExtras.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "sair_dialect.h"
@@ -214,6 +218,209 @@ llvm::SmallVector<mlir::Value> LoadExpansionPattern::Emit(
   return {load};
 }
 
+// Number of bytes to prefetch ahead of the current access, corresponding to
+// eight 64-byte cache lines.
+constexpr int64_t kPrefetchDistanceBytes = 512;
+
+// Returns the innermost loop of `op`, or nullptr if the loop nest is not
+// specified or empty.
+LoopAttr InnermostLoop(SairLoadFromMemRefOp op) {
+  auto sair_op = cast<SairOp>(op.getOperation());
+  if (sair_op.NumInstances() != 1) return nullptr;
+  mlir::ArrayAttr loop_nest = sair_op.GetDecisions(0).loop_nest();
+  if (loop_nest == nullptr || loop_nest.empty()) return nullptr;
+  return loop_nest.getValue().back().cast<LoopAttr>();
+}
+
+// Returns the number of elements `layout_expr` advances by on each iteration
+// of a loop iterating along `iter`, if known. A loop on the outer strips of a
+// dimension advances by the size of a strip, whether the dimension is
+// strip-mined in the loop nest or in the layout.
+std::optional<int> IterationStep(MappingExpr iter, MappingExpr layout_expr) {
+  if (auto stripe_expr = iter.dyn_cast<MappingStripeExpr>()) {
+    if (stripe_expr.operand() != layout_expr) return std::nullopt;
+    return stripe_expr.factors().back();
+  }
+
+  auto dim_expr = iter.dyn_cast<MappingDimExpr>();
+  if (dim_expr == nullptr) return std::nullopt;
+  if (layout_expr == dim_expr) return 1;
+  auto unstripe_expr = layout_expr.dyn_cast<MappingUnStripeExpr>();
+  if (unstripe_expr == nullptr) return std::nullopt;
+  for (auto [operand, factor] :
+       llvm::zip(unstripe_expr.operands(), unstripe_expr.factors())) {
+    if (operand == dim_expr) return factor;
+  }
+  return std::nullopt;
+}
+
+// Returns the memref dimension walked by the innermost loop of `op`, if the
+// innermost loop iterates on a single domain dimension, exactly one memref
+// dimension depends on it, each iteration advances by one element along that
+// dimension and that dimension has a static stride.
+std::optional<int> PrefetchedMemRefDimension(SairLoadFromMemRefOp op) {
+  LoopAttr loop = InnermostLoop(op);
+  if (loop == nullptr) return std::nullopt;
+  int domain_size = op.getDomain().size();
+  llvm::SmallBitVector loop_dims = loop.iter().DependencyMask(domain_size);
+  if (loop_dims.count() != 1) return std::nullopt;
+
+  std::optional<int> memref_dimension;
+  for (auto en : llvm::enumerate(op.getLayout())) {
+    if (!en.value().DependencyMask(domain_size).anyCommon(loop_dims)) continue;
+    if (memref_dimension.has_value()) return std::nullopt;
+    memref_dimension = en.index();
+  }
+  if (!memref_dimension.has_value()) return std::nullopt;
+
+  // The prefetch is issued once per iteration of the innermost loop, so the
+  // distance is only meaningful if an iteration advances by one element.
+  std::optional<int> step =
+      IterationStep(loop.iter(), op.getLayout().Dimension(*memref_dimension));
+  if (step != 1) return std::nullopt;
+
+  // The distance in elements is derived from the stride of the dimension,
+  // which must be known statically.
+  mlir::MemRefType memref_type = op.MemRefType();
+  if (!memref_type.getElementType().isIntOrFloat()) return std::nullopt;
+  llvm::SmallVector<int64_t> strides;
+  int64_t offset;
+  if (mlir::failed(mlir::getStridesAndOffset(memref_type, strides, offset)) ||
+      mlir::ShapedType::isDynamic(strides[*memref_dimension]) ||
+      strides[*memref_dimension] <= 0) {
+    return std::nullopt;
+  }
+  return memref_dimension;
+}
+
+// Returns a static upper bound of the number of iterations of a loop iterating
+// along `iter` in the domain of `op`, if any. Inner loops of a strip-mined
+// dimension are bounded by the size of a strip even if the dimension is not.
+std::optional<int64_t> StaticTripCount(SairLoadFromMemRefOp op,
+                                       MappingExpr iter) {
+  if (auto dim_expr = iter.dyn_cast<MappingDimExpr>()) {
+    auto range = op.getShape()
+                     .Dimension(dim_expr.dimension())
+                     .type()
+                     .dyn_cast<StaticRangeType>();
+    if (range == nullptr) return std::nullopt;
+    return llvm::divideCeil(range.size(), range.getStep());
+  }
+
+  auto stripe_expr = iter.dyn_cast<MappingStripeExpr>();
+  if (stripe_expr == nullptr) return std::nullopt;
+  llvm::ArrayRef<int> factors = stripe_expr.factors();
+  std::optional<int64_t> trip_count =
+      StaticTripCount(op, stripe_expr.operand());
+  if (trip_count.has_value()) {
+    trip_count = llvm::divideCeil(*trip_count, factors.back());
+  }
+  if (factors.size() > 1) {
+    int64_t strip_trip_count = factors[factors.size() - 2] / factors.back();
+    trip_count = std::min(trip_count.value_or(strip_trip_count),
+                          strip_trip_count);
+  }
+  return trip_count;
+}
+
+// Returns the number of iterations within a strip of `dimension` if
+// `layout_expr` indexes the memref with `dimension` as an inner operand of an
+// unstripe expression. This bounds the trip count of loops iterating on strips
+// once loops are normalized and strips are represented by dynamic ranges.
+std::optional<int64_t> StripTripCount(MappingExpr layout_expr, int dimension) {
+  auto unstripe_expr = layout_expr.dyn_cast<MappingUnStripeExpr>();
+  if (unstripe_expr == nullptr) return std::nullopt;
+  llvm::ArrayRef<int> factors = unstripe_expr.factors();
+  for (int i = 1, e = factors.size(); i < e; ++i) {
+    auto dim_expr = unstripe_expr.operands()[i].dyn_cast<MappingDimExpr>();
+    if (dim_expr == nullptr || dim_expr.dimension() != dimension) continue;
+    return factors[i - 1] / factors[i];
+  }
+  return std::nullopt;
+}
+
+// Returns the number of elements to prefetch ahead along `memref_dimension`.
+// This covers kPrefetchDistanceBytes given the stride of the dimension, but
+// does not exceed the trip count of the innermost loop when it is bounded
+// statically.
+int64_t PrefetchDistance(SairLoadFromMemRefOp op, int memref_dimension) {
+  mlir::MemRefType memref_type = op.MemRefType();
+  llvm::SmallVector<int64_t> strides;
+  int64_t offset;
+  AssertSuccess(mlir::getStridesAndOffset(memref_type, strides, offset));
+  int64_t element_bytes =
+      llvm::divideCeil(memref_type.getElementTypeBitWidth(), 8);
+  int64_t stride_bytes = strides[memref_dimension] * element_bytes;
+  int64_t distance = llvm::divideCeil(kPrefetchDistanceBytes, stride_bytes);
+
+  MappingExpr loop_iter = InnermostLoop(op).iter();
+  std::optional<int64_t> trip_count = StaticTripCount(op, loop_iter);
+  if (trip_count.has_value()) distance = std::min(distance, *trip_count);
+  if (auto dim_expr = loop_iter.dyn_cast<MappingDimExpr>()) {
+    std::optional<int64_t> strip_trip_count = StripTripCount(
+        op.getLayout().Dimension(memref_dimension), dim_expr.dimension());
+    if (strip_trip_count.has_value()) {
+      distance = std::min(distance, *strip_trip_count);
+    }
+  }
+  return std::max<int64_t>(distance, 1);
+}
+
+// Expansion pattern that implements a sair.load_from_memref operation by
+// memref.load and prefetches the data accessed by later iterations of the
+// innermost loop with memref.prefetch. The prefetch is a hint: the pattern
+// applies to any load and only emits the prefetch if the innermost loop walks a
+// memref dimension with a static stride. This is decided when the pattern is
+// emitted so that the choice reflects the loop nest after normalization.
+class LoadPrefetchExpansionPattern
+    : public TypedExpansionPattern<SairLoadFromMemRefOp> {
+ public:
+  constexpr static llvm::StringRef kName = kLoadPrefetchExpansionPattern;
+
+  mlir::LogicalResult Match(SairLoadFromMemRefOp op) const override;
+
+  llvm::SmallVector<mlir::Value> Emit(SairLoadFromMemRefOp op,
+                                      MapBodyBuilder &map_body,
+                                      mlir::OpBuilder &builder) const override;
+};
+
+mlir::LogicalResult LoadPrefetchExpansionPattern::Match(
+    SairLoadFromMemRefOp op) const {
+  return mlir::success();
+}
+
+llvm::SmallVector<mlir::Value> LoadPrefetchExpansionPattern::Emit(
+    SairLoadFromMemRefOp op, MapBodyBuilder &map_body,
+    mlir::OpBuilder &builder) const {
+  mlir::Location loc = op.getLoc();
+  mlir::MLIRContext *context = builder.getContext();
+  mlir::Value memref = map_body.block_input(0);
+  llvm::SmallVector<mlir::Value> indices =
+      LoadStoreIndices(loc, op.DomainWithDependencies(), op.getLayout(),
+                       map_body, builder);
+  auto load = builder.create<mlir::memref::LoadOp>(loc, memref, indices);
+
+  std::optional<int> prefetched_dimension = PrefetchedMemRefDimension(op);
+  if (!prefetched_dimension.has_value()) return {load};
+
+  // Prefetch `distance` elements ahead, clamping the index to the memref size.
+  int dimension = *prefetched_dimension;
+  int64_t distance = PrefetchDistance(op, dimension);
+  auto d0 = mlir::getAffineDimExpr(0, context);
+  auto s0 = mlir::getAffineSymbolExpr(0, context);
+  auto map = mlir::AffineMap::get(1, 1, {d0 + distance, s0 - 1}, context);
+  mlir::Value size =
+      builder.create<mlir::memref::DimOp>(loc, memref, dimension);
+  llvm::SmallVector<mlir::Value> prefetch_indices = indices;
+  prefetch_indices[dimension] = builder.create<affine::AffineMinOp>(
+      loc, map, llvm::ArrayRef({indices[dimension], size}));
+  builder.create<mlir::memref::PrefetchOp>(loc, memref, prefetch_indices,
+                                           /*isWrite=*/false,
+                                           /*localityHint=*/3,
+                                           /*isDataCache=*/true);
+  return {load};
+}
+
 // Expansion pattern that implements a sair.load_from_memref operation by
 // memref.load
 class StoreExpansionPattern
@@ -232,14 +439,48 @@ mlir::LogicalResult StoreExpansionPattern::Match(SairStoreToMemRefOp op) const {
   return mlir::success();
 }
 
-llvm::SmallVector<mlir::Value> StoreExpansionPattern::Emit(
-    SairStoreToMemRefOp op, MapBodyBuilder &map_body,
-    mlir::OpBuilder &builder) const {
+// Implements `op` by a memref.store in `map_body`. The store bypasses caches if
+// `nontemporal` is set.
+void EmitStore(SairStoreToMemRefOp op, bool nontemporal,
+               MapBodyBuilder &map_body, mlir::OpBuilder &builder) {
   llvm::SmallVector<mlir::Value> indices =
       LoadStoreIndices(op.getLoc(), op.DomainWithDependencies(), op.getLayout(),
                        map_body, builder);
-  builder.create<mlir::memref::StoreOp>(op.getLoc(), map_body.block_input(1),
-                                        map_body.block_input(0), indices);
+  auto store = builder.create<mlir::memref::StoreOp>(
+      op.getLoc(), map_body.block_input(1), map_body.block_input(0), indices);
+  store.setNontemporal(nontemporal);
+}
+
+llvm::SmallVector<mlir::Value> StoreExpansionPattern::Emit(
+    SairStoreToMemRefOp op, MapBodyBuilder &map_body,
+    mlir::OpBuilder &builder) const {
+  EmitStore(op, /*nontemporal=*/false, map_body, builder);
+  return {};
+}
+
+// Expansion pattern that implements a sair.store_to_memref operation by a
+// non-temporal memref.store, that bypasses caches.
+class StoreNonTemporalExpansionPattern
+    : public TypedExpansionPattern<SairStoreToMemRefOp> {
+ public:
+  constexpr static llvm::StringRef kName = kStoreNonTemporalExpansionPattern;
+
+  mlir::LogicalResult Match(SairStoreToMemRefOp op) const override;
+
+  llvm::SmallVector<mlir::Value> Emit(SairStoreToMemRefOp op,
+                                      MapBodyBuilder &map_body,
+                                      mlir::OpBuilder &builder) const override;
+};
+
+mlir::LogicalResult StoreNonTemporalExpansionPattern::Match(
+    SairStoreToMemRefOp op) const {
+  return mlir::success();
+}
+
+llvm::SmallVector<mlir::Value> StoreNonTemporalExpansionPattern::Emit(
+    SairStoreToMemRefOp op, MapBodyBuilder &map_body,
+    mlir::OpBuilder &builder) const {
+  EmitStore(op, /*nontemporal=*/true, map_body, builder);
   return {};
 }
 
@@ -257,7 +498,9 @@ void RegisterExpansionPatterns(
     llvm::StringMap<std::unique_ptr<ExpansionPattern>> &map) {
   RegisterExpansionPattern<MapExpansionPattern, CopyExpansionPattern,
                            AllocExpansionPattern, FreeExpansionPattern,
-                           LoadExpansionPattern, StoreExpansionPattern>(map);
+                           LoadExpansionPattern, LoadPrefetchExpansionPattern,
+                           StoreExpansionPattern,
+                           StoreNonTemporalExpansionPattern>(map);
 }
 
 }  // namespace sair
@@ -29,7 +29,10 @@ constexpr llvm::StringRef kCopyExpansionPattern = "copy";
 constexpr llvm::StringRef kAllocExpansionPattern = "alloc";
 constexpr llvm::StringRef kFreeExpansionPattern = "free";
 constexpr llvm::StringRef kLoadExpansionPattern = "load";
+constexpr llvm::StringRef kLoadPrefetchExpansionPattern = "load_prefetch";
 constexpr llvm::StringRef kStoreExpansionPattern = "store";
+constexpr llvm::StringRef kStoreNonTemporalExpansionPattern =
+    "store_nontemporal";
 
 // Verifies expansion patterns apply to operations where they are specified.
 mlir::LogicalResult VerifyExpansionPatterns(SairProgramOp program);
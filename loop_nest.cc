@@ -14,12 +14,27 @@
 
 #include "loop_nest.h"
 
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "mlir/IR/Builders.h"
 #include "sequence.h"
 #include "util.h"
 
+#define DEBUG_TYPE "sair-loop-nest"
+
+STATISTIC(NumIterationSpaceAnalyses,
+          "Number of iteration space analyses computed");
+STATISTIC(NumIterationSpaceCacheHits,
+          "Number of iteration spaces found in the analysis cache");
+STATISTIC(NumLoopFusionAnalyses, "Number of loop fusion analyses computed");
+STATISTIC(NumFusionMappingsUnified,
+          "Number of loop mappings unified with fusion classes");
+STATISTIC(NumFusionMappingsReused,
+          "Number of loop occurrences matching an already unified occurrence");
+
 namespace sair {
 
 IterationSpace::IterationSpace(llvm::SmallVector<mlir::StringAttr> loop_names,
@@ -84,20 +99,41 @@ static IterationSpace InferIterationSpace(
 
 IterationSpaceAnalysis::IterationSpaceAnalysis(SairProgramOp program_op) {
   if (program_op == nullptr) return;
-  program_op.WalkOpInstances(
-      [&](const OpInstance &op) { ComputeIterationSpace(op); });
+  ++NumIterationSpaceAnalyses;
 }
 
 const IterationSpace &IterationSpaceAnalysis::Get(const OpInstance &op) const {
-  return iteration_space_.find(op)->second;
+  if (auto it = iteration_space_.find(op); it != iteration_space_.end()) {
+    ++NumIterationSpaceCacheHits;
+    return *it->second;
+  }
+  return ComputeIterationSpace(op);
 }
 
-const IterationSpace &IterationSpaceAnalysis::ComputeIterationSpace(
-    const OpInstance &op) {
-  if (auto it = iteration_space_.find(op); it != iteration_space_.end()) {
-    return it->second;
+void IterationSpaceAnalysis::ComputeAll(SairProgramOp program_op) const {
+  program_op.WalkOpInstances([&](const OpInstance &op) { Get(op); });
+}
+
+void IterationSpaceAnalysis::Invalidate(const OpInstance &op) {
+  iteration_space_.erase(op);
+  llvm::SmallVector<OpInstance> inferred;
+  for (const auto &[other, iteration_space] : iteration_space_) {
+    if (!other.isa<ComputeOpInstance>()) inferred.push_back(other);
   }
+  for (const OpInstance &other : inferred) iteration_space_.erase(other);
+}
 
+IterationSpace &IterationSpaceAnalysis::Memoize(
+    const OpInstance &op, IterationSpace iteration_space) const {
+  auto entry = std::make_shared<IterationSpace>(std::move(iteration_space));
+  bool inserted = iteration_space_.try_emplace(op, entry).second;
+  assert(inserted && "iteration space memoized twice");
+  (void)inserted;
+  return *entry;
+}
+
+const IterationSpace &IterationSpaceAnalysis::ComputeIterationSpace(
+    const OpInstance &op) const {
   if (auto compute_op = op.dyn_cast<ComputeOpInstance>()) {
     int num_loops = compute_op.Loops().size();
     llvm::SmallVector<MappingExpr> exprs;
@@ -114,32 +150,30 @@ const IterationSpace &IterationSpaceAnalysis::ComputeIterationSpace(
     DecisionsAttr decisions = compute_op.GetDecisions();
     bool fully_specified = decisions.loop_nest() != nullptr;
     auto mapping = MappingAttr::get(op.context(), op.domain_size(), exprs);
-    return iteration_space_
-        .try_emplace(op, loop_names, mapping, fully_specified)
-        .first->second;
+    return Memoize(op, IterationSpace(loop_names, mapping, fully_specified));
   }
 
-  // Temporarily set an empty iteration space to avoid infinite recursion.
+  // Temporarily set an empty iteration space to avoid infinite recursion. The
+  // entry is then updated in place with the inferred iteration space.
   auto empty_mapping = MappingAttr::get(op.context(), op.domain_size(), {});
   llvm::SmallVector<mlir::StringAttr> empty_names;
-  auto it =
-      iteration_space_.try_emplace(op, empty_names, empty_mapping, false).first;
+  IterationSpace &entry =
+      Memoize(op, IterationSpace(empty_names, empty_mapping, false));
 
   // If `op` is not a ComputeOpInstance, it is a SairOp.
   mlir::Operation *operation = op.GetDuplicatedOp();
   auto infer_iteration_space = dyn_cast<InferIterationSpaceOp>(operation);
-  if (infer_iteration_space == nullptr) return it->second;
+  if (infer_iteration_space == nullptr) return entry;
   int operand_pos = infer_iteration_space.infer_iteration_space_operand();
 
   auto operand_value = op.Operand(operand_pos).GetValue();
-  if (!operand_value.has_value()) return it->second;
+  if (!operand_value.has_value()) return entry;
 
   ValueOperand operand = cast<SairOp>(operation).ValueOperands()[operand_pos];
   const IterationSpace &parent_iteration_space =
-      ComputeIterationSpace(operand_value->defining_op());
-  it = iteration_space_.find(op);
-  it->second = InferIterationSpace(parent_iteration_space, operand);
-  return it->second;
+      Get(operand_value->defining_op());
+  entry = InferIterationSpace(parent_iteration_space, operand);
+  return entry;
 }
 
 MappingAttr IterationSpaceAnalysis::TranslateMapping(
@@ -257,6 +291,21 @@ class LoopNestConstraintsAnalysis {
   llvm::DenseMap<OpInstance, Constraints> constraints_;
 };
 
+// Returns true if `iter` iterates on a whole dynamic range of `shape` that does
+// not depend on other dimensions. Such loops never have a static trip count.
+static bool IteratesOnDynamicRange(MappingExpr iter, DomainShapeAttr shape) {
+  if (auto stripe_expr = iter.dyn_cast<MappingStripeExpr>()) {
+    // Inner stripes are bounded by the size of the outer stripe.
+    if (stripe_expr.factors().size() > 1) return false;
+    iter = stripe_expr.operand();
+  }
+  auto dim_expr = iter.dyn_cast<MappingDimExpr>();
+  if (dim_expr == nullptr) return false;
+  const DomainShapeDim &dimension = shape.Dimension(dim_expr.dimension());
+  return dimension.type().isa<DynRangeType>() &&
+         dimension.DependencyMask().none();
+}
+
 mlir::LogicalResult VerifyLoopNestWellFormed(
     mlir::Location loc, DomainShapeAttr shape,
     llvm::ArrayRef<mlir::Attribute> loop_nest) {
@@ -286,6 +335,17 @@ mlir::LogicalResult VerifyLoopNestWellFormed(
              << "loop iterators cannot contain `?` expressions";
     }
 
+    // Unroll-and-jam requires a static trip count. Dynamic ranges that depend
+    // on other dimensions, such as strips once loops are normalized, may still
+    // have one and are only checked when loops are introduced.
+    if (loop.unroll_and_jam() != nullptr &&
+        IteratesOnDynamicRange(loop.iter(), shape)) {
+      return mlir::emitError(loc)
+             << "loop " << loop.name()
+             << " iterates on a dynamic range and cannot be unrolled and "
+                "jammed";
+    }
+
     iter_exprs.push_back(loop.iter());
   }
 
@@ -608,6 +668,17 @@ LoopFusionAnalysis::LoopFusionAnalysis(
   (void)status;
 }
 
+LoopFusionAnalysis::LoopFusionAnalysis(mlir::Operation *operation,
+                                       mlir::AnalysisManager &analysis_manager)
+    : context_(operation->getContext()) {
+  SairProgramOp program_op = dyn_cast<SairProgramOp>(operation);
+  if (program_op == nullptr) return;
+  mlir::LogicalResult status =
+      Init(program_op, analysis_manager.getAnalysis<SequenceAnalysis>());
+  assert(mlir::succeeded(status));
+  (void)status;
+}
+
 std::optional<LoopFusionAnalysis> LoopFusionAnalysis::Create(
     SairProgramOp program_op, const SequenceAnalysis &sequence_analysis) {
   LoopFusionAnalysis analysis(program_op->getContext());
@@ -619,6 +690,7 @@ std::optional<LoopFusionAnalysis> LoopFusionAnalysis::Create(
 
 mlir::LogicalResult LoopFusionAnalysis::Init(
     SairProgramOp program_op, const SequenceAnalysis &sequence_analysis) {
+  ++NumLoopFusionAnalyses;
   llvm::SmallVector<ComputeOpInstance> work_list;
   program_op.WalkComputeOpInstances([&](const ComputeOpInstance &compute_op) {
     auto none_expr = MappingNoneExpr::get(context_);
@@ -677,6 +749,17 @@ static unsigned ExtractUnrollFactor(const ComputeOpInstance &op, unsigned pos) {
   return 0u;
 }
 
+// Returns the unroll-and-jam factor of the `pos`-th loop in the given compute
+// op. Expects the op to have a well-formed loop nest attribute.
+static unsigned ExtractUnrollAndJamFactor(const ComputeOpInstance &op,
+                                          unsigned pos) {
+  auto loop = op.Loops()[pos].cast<LoopAttr>();
+  if (mlir::IntegerAttr unroll_and_jam_factor = loop.unroll_and_jam()) {
+    return unroll_and_jam_factor.getInt();
+  }
+  return 0u;
+}
+
 mlir::LogicalResult LoopFusionAnalysis::RegisterLoop(
     const ComputeOpInstance &op, int loop_pos,
     const SequenceAnalysis &sequence_analysis) {
@@ -722,6 +805,16 @@ mlir::LogicalResult LoopFusionAnalysis::RegisterLoop(
       diag.attachNote(fusion_class.location()) << "previous occurrence here";
       return diag;
     }
+    int unroll_and_jam_factor = ExtractUnrollAndJamFactor(op, loop_pos);
+    if (unroll_and_jam_factor != fusion_class.unroll_and_jam_factor()) {
+      mlir::InFlightDiagnostic diag =
+          op.EmitError() << "mismatching unroll-and-jam factors for loop "
+                         << loop.name() << " (" << unroll_and_jam_factor
+                         << " vs " << fusion_class.unroll_and_jam_factor()
+                         << ")";
+      diag.attachNote(fusion_class.location()) << "previous occurrence here";
+      return diag;
+    }
     fusion_class.AddUse(op, sequence_analysis);
   }
 
@@ -729,8 +822,8 @@ mlir::LogicalResult LoopFusionAnalysis::RegisterLoop(
   auto domain_with_dependencies =
       llvm::to_vector<4>(op.DomainWithDependencies());
   assert(fusion_class.loop_nest().size() == loop_nest_mapping.size());
-  return fusion_class.UnifyMapping(op, loop_nest_mapping, mapping,
-                                   domain_with_dependencies);
+  return fusion_class.UnifyOccurrence(op, loop_nest_mapping, mapping,
+                                      domain_with_dependencies);
 }
 
 LoopNest LoopFusionAnalysis::GetLoopNest(
@@ -756,7 +849,8 @@ LoopFusionClass::LoopFusionClass(mlir::StringAttr name,
                                  const LoopNest &loop_nest)
     : MappedDomain(op.getLoc(), "loop", name, loop_nest),
       last_op_(op),
-      unroll_factor_(ExtractUnrollFactor(op, loop_nest.size())) {
+      unroll_factor_(ExtractUnrollFactor(op, loop_nest.size())),
+      unroll_and_jam_factor_(ExtractUnrollAndJamFactor(op, loop_nest.size())) {
   num_dependencies_ = loop_nest.size();
   AddNonePrefixToMapping(1);
 }
@@ -766,6 +860,42 @@ void LoopFusionClass::AddUse(const ComputeOpInstance &op,
   if (sequence_analysis.IsBefore(last_op_, op)) last_op_ = op;
 }
 
+mlir::LogicalResult LoopFusionClass::UnifyOccurrence(
+    const ComputeOpInstance &op, MappingAttr loop_nest_mapping,
+    MappingAttr mapping, llvm::ArrayRef<ValueAccessInstance> domain) {
+  llvm::hash_code domain_hash = llvm::hash_value(domain.size());
+  for (const ValueAccessInstance &dimension : domain) {
+    domain_hash = llvm::hash_combine(domain_hash, dimension.value.HashValue(),
+                                     dimension.mapping.getAsOpaquePointer());
+  }
+
+  // Unification only depends on the mappings and the domain of the occurrence,
+  // and fusion classes are only ever refined by unification. Unifying an
+  // occurrence identical to one already unified is thus a no-op.
+  auto same_dimension = [](const ValueAccessInstance &lhs,
+                           const ValueAccessInstance &rhs) {
+    return lhs.value == rhs.value && lhs.mapping == rhs.mapping;
+  };
+  llvm::SmallVector<Occurrence, 1> &occurrences =
+      unified_occurrences_[{loop_nest_mapping, mapping}];
+  for (const Occurrence &occurrence : occurrences) {
+    if (occurrence.domain_hash == static_cast<unsigned>(domain_hash) &&
+        llvm::equal(occurrence.domain, domain, same_dimension)) {
+      ++NumFusionMappingsReused;
+      return mlir::success();
+    }
+  }
+
+  ++NumFusionMappingsUnified;
+  if (mlir::failed(UnifyMapping(op, loop_nest_mapping, mapping, domain))) {
+    return mlir::failure();
+  }
+  Occurrence &occurrence = occurrences.emplace_back();
+  occurrence.domain_hash = static_cast<unsigned>(domain_hash);
+  occurrence.domain.assign(domain.begin(), domain.end());
+  return mlir::success();
+}
+
 void LoopFusionClass::TrimDependencies(int num_dependencies) {
   num_dependencies_ = num_dependencies;
   for (auto &dimension : domain_) {
@@ -779,6 +909,12 @@ mlir::IntegerAttr LoopFusionClass::GetUnrollAttr(
   return mlir::Builder(&context).getI64IntegerAttr(unroll_factor_);
 }
 
+mlir::IntegerAttr LoopFusionClass::GetUnrollAndJamAttr(
+    mlir::MLIRContext &context) const {
+  if (unroll_and_jam_factor_ == 0) return {};
+  return mlir::Builder(&context).getI64IntegerAttr(unroll_and_jam_factor_);
+}
+
 ProgramPoint LoopFusionClass::EndPoint() const {
   return ProgramPoint(last_op_, Direction::kAfter, loop_nest());
 }
@@ -15,8 +15,11 @@
 #ifndef SAIR_LOOP_NEST_H_
 #define SAIR_LOOP_NEST_H_
 
+#include <memory>
+
 #include "llvm/ADT/DenseMap.h"
 #include "mlir/IR/Attributes.h"
+#include "mlir/Pass/AnalysisManager.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mapped_domain.h"
 #include "sair_op_interfaces.h"
@@ -76,7 +79,9 @@ class IterationSpace {
   bool fully_specified_;
 };
 
-// Compute iteration spaces for each operation and value.
+// Compute iteration spaces for each operation and value. Iteration spaces are
+// computed on demand and memoized, so that passes only querying a few
+// operations do not pay for the whole program.
 class IterationSpaceAnalysis {
  public:
   explicit IterationSpaceAnalysis(SairProgramOp program_op);
@@ -87,6 +92,21 @@ class IterationSpaceAnalysis {
   // iteration space if the loop nest is left unspecified.
   const IterationSpace &Get(const OpInstance &op) const;
 
+  // Computes the iteration spaces of all operations of `program_op` ahead of
+  // time. Passes that modify the program while querying the analysis call this
+  // first so that they observe iteration spaces as they were before
+  // modifications.
+  void ComputeAll(SairProgramOp program_op) const;
+
+  // Drops the memoized iteration space of `op`, along with iteration spaces
+  // inferred from other operations as they may depend on `op`. Must be called
+  // before `op` is erased or rewritten. References previously returned for
+  // dropped iteration spaces must no longer be used.
+  void Invalidate(const OpInstance &op);
+
+  // Drops all memoized iteration spaces.
+  void InvalidateAll() { iteration_space_.clear(); }
+
   // Translates a mapping from the domain of `from` to the domain of `to` into a
   // mapping from the iteration space of `from` to the iteration space of `to`.
   // Maps common loops with the identity function.
@@ -100,9 +120,17 @@ class IterationSpaceAnalysis {
 
  private:
   // Computes the iteration space for the given operation.
-  const IterationSpace &ComputeIterationSpace(const OpInstance &op);
+  const IterationSpace &ComputeIterationSpace(const OpInstance &op) const;
 
-  llvm::DenseMap<OpInstance, IterationSpace> iteration_space_;
+  // Memoizes the iteration space of `op`, which must not have an entry yet.
+  // Returns the entry so that it can be updated in place.
+  IterationSpace &Memoize(const OpInstance &op,
+                          IterationSpace iteration_space) const;
+
+  // Iteration spaces are heap-allocated so that references returned by `Get`
+  // remain valid when new entries are memoized.
+  mutable llvm::DenseMap<OpInstance, std::shared_ptr<IterationSpace>>
+      iteration_space_;
 };
 
 // A class of fused loops.
@@ -116,6 +144,14 @@ class LoopFusionClass : public MappedDomain {
   void AddUse(const ComputeOpInstance &op,
               const SequenceAnalysis &sequence_analysis);
 
+  // Unifies the loop mapping with an occurrence of the loop in `op`, as
+  // MappedDomain::UnifyMapping does. Unification is skipped if an occurrence
+  // with the same mappings and domain was already unified, as it would leave
+  // the fusion class unchanged.
+  mlir::LogicalResult UnifyOccurrence(
+      const ComputeOpInstance &op, MappingAttr loop_nest_mapping,
+      MappingAttr mapping, llvm::ArrayRef<ValueAccessInstance> domain);
+
   // Program point at which the loop ends.
   ProgramPoint EndPoint() const;
 
@@ -129,7 +165,21 @@ class LoopFusionClass : public MappedDomain {
   // constructing a loop nest attribute.
   mlir::IntegerAttr GetUnrollAttr(mlir::MLIRContext &context) const;
 
+  // Returns the unroll-and-jam factor of the loop, zero if no unroll-and-jam is
+  // specified.
+  unsigned unroll_and_jam_factor() const { return unroll_and_jam_factor_; }
+
+  // Returns the attribute containing the unroll-and-jam factor suitable for
+  // constructing a loop nest attribute.
+  mlir::IntegerAttr GetUnrollAndJamAttr(mlir::MLIRContext &context) const;
+
  private:
+  // An occurrence of the loop already unified with the fusion class.
+  struct Occurrence {
+    unsigned domain_hash;
+    llvm::SmallVector<ValueAccessInstance, 4> domain;
+  };
+
   // Last loop of the loop nest this loop depends on.
   int num_dependencies_;
   llvm::SmallVector<ValueAccess> domain_;
@@ -138,6 +188,15 @@ class LoopFusionClass : public MappedDomain {
 
   // Unroll factor of the (current) loop.
   unsigned unroll_factor_;
+
+  // Unroll-and-jam factor of the (current) loop.
+  unsigned unroll_and_jam_factor_;
+
+  // Occurrences already unified with the fusion class, indexed by the mapping
+  // to outer loops and the mapping to this loop.
+  llvm::DenseMap<std::pair<mlir::Attribute, mlir::Attribute>,
+                 llvm::SmallVector<Occurrence, 1>>
+      unified_occurrences_;
 };
 
 // A loop nest of fused loops.
@@ -178,7 +237,9 @@ class LoopNest {
   const LoopFusionClass *fusion_class_ = nullptr;
 };
 
-// Computes loop fusion classes in a sair program.
+// Computes loop fusion classes in a sair program. The analysis is not updated
+// incrementally: passes that change loop nests or add operations to loops must
+// not preserve it.
 class LoopFusionAnalysis {
  public:
   // Builds an analysis populated with all loops appearing in `program_op`. Uses
@@ -187,6 +248,11 @@ class LoopFusionAnalysis {
       mlir::Operation *operation,
       const SequenceAnalysis *sequence_analysis = nullptr);
 
+  // Builds an analysis populated with all loops appearing in `operation`,
+  // reusing the sequence analysis cached by `analysis_manager`.
+  LoopFusionAnalysis(mlir::Operation *operation,
+                     mlir::AnalysisManager &analysis_manager);
+
   // Creates a LoopFusionAnalysis populated with the loops appearing in
   // `program_op`. Returns `nullopt` if the analysis fails.
   static std::optional<LoopFusionAnalysis> Create(
@@ -17,6 +17,7 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -31,6 +32,10 @@
 #include "mlir/IR/Types.h"
 #include "sair_dialect.h"
 
+#define DEBUG_TYPE "sair-attributes"
+
+STATISTIC(NumMappingsComposed, "Number of mappings composed");
+
 namespace sair {
 
 #include "sair_attr_interfaces.cc.inc"
@@ -762,6 +767,7 @@ llvm::ArrayRef<MappingExpr> MappingAttr::Dimensions() const {
 int MappingAttr::UseDomainSize() const { return getImpl()->use_domain_size(); }
 
 MappingAttr MappingAttr::Compose(MappingAttr other) const {
+  ++NumMappingsComposed;
   llvm::SmallVector<MappingExpr, 4> new_mapping_dims;
   new_mapping_dims.reserve(other.size());
   for (MappingExpr other_expr : other) {
@@ -1434,7 +1440,14 @@ mlir::ArrayAttr EraseOperandFromDecisions(mlir::ArrayAttr decisions,
 
 LoopAttr LoopAttr::get(mlir::StringAttr name, MappingExpr iter,
                        mlir::IntegerAttr unroll, mlir::MLIRContext *context) {
-  llvm::SmallVector<mlir::NamedAttribute, 3> fields;
+  return get(name, iter, unroll, /*unroll_and_jam=*/nullptr, context);
+}
+
+LoopAttr LoopAttr::get(mlir::StringAttr name, MappingExpr iter,
+                       mlir::IntegerAttr unroll,
+                       mlir::IntegerAttr unroll_and_jam,
+                       mlir::MLIRContext *context) {
+  llvm::SmallVector<mlir::NamedAttribute, 4> fields;
   assert(name);
   auto name_id = mlir::StringAttr::get(context, "name");
   fields.emplace_back(name_id, name);
@@ -1448,6 +1461,11 @@ LoopAttr LoopAttr::get(mlir::StringAttr name, MappingExpr iter,
     fields.emplace_back(unroll_id, unroll);
   }
 
+  if (unroll_and_jam) {
+    auto unroll_and_jam_id = mlir::StringAttr::get(context, "unroll_and_jam");
+    fields.emplace_back(unroll_and_jam_id, unroll_and_jam);
+  }
+
   mlir::Attribute dict = mlir::DictionaryAttr::get(context, fields);
   return dict.dyn_cast<LoopAttr>();
 }
@@ -1463,16 +1481,20 @@ bool LoopAttr::classof(mlir::Attribute attr) {
   auto iter = derived.get("iter");
   if (!iter.isa_and_nonnull<sair::MappingExpr>()) return false;
 
-  auto unroll = derived.get("unroll");
-  if (!unroll) return derived.size() == 2;
-
-  auto intUnroll = unroll.dyn_cast<mlir::IntegerAttr>();
-  if (!intUnroll || !intUnroll.getType().isSignlessInteger(64) ||
-      !intUnroll.getValue().isStrictlyPositive()) {
-    return false;
+  // Unroll factors are optional.
+  int num_fields = 2;
+  for (llvm::StringRef factor_name : {"unroll", "unroll_and_jam"}) {
+    auto factor = derived.get(factor_name);
+    if (!factor) continue;
+    auto int_factor = factor.dyn_cast<mlir::IntegerAttr>();
+    if (!int_factor || !int_factor.getType().isSignlessInteger(64) ||
+        !int_factor.getValue().isStrictlyPositive()) {
+      return false;
+    }
+    ++num_fields;
   }
 
-  return derived.size() == 3;
+  return derived.size() == num_fields;
 }
 
 mlir::StringAttr LoopAttr::name() const {
@@ -1499,6 +1521,15 @@ mlir::IntegerAttr LoopAttr::unroll() const {
   return unroll.cast<mlir::IntegerAttr>();
 }
 
+mlir::IntegerAttr LoopAttr::unroll_and_jam() const {
+  auto derived = this->cast<mlir::DictionaryAttr>();
+  auto unroll_and_jam = derived.get("unroll_and_jam");
+  if (!unroll_and_jam) return nullptr;
+  assert(unroll_and_jam.isa<mlir::IntegerAttr>() &&
+         "incorrect Attribute type found.");
+  return unroll_and_jam.cast<mlir::IntegerAttr>();
+}
+
 BufferAttr BufferAttr::get(mlir::StringAttr space, mlir::StringAttr name,
                            NamedMappingAttr layout,
                            mlir::MLIRContext *context) {
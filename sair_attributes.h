@@ -572,10 +572,17 @@ class LoopAttr : public mlir::DictionaryAttr {
   static bool classof(mlir::Attribute attr);
   static LoopAttr get(mlir::StringAttr name, MappingExpr iter,
                       mlir::IntegerAttr unroll, mlir::MLIRContext *context);
+  static LoopAttr get(mlir::StringAttr name, MappingExpr iter,
+                      mlir::IntegerAttr unroll,
+                      mlir::IntegerAttr unroll_and_jam,
+                      mlir::MLIRContext *context);
 
   mlir::StringAttr name() const;
   MappingExpr iter() const;
   mlir::IntegerAttr unroll() const;
+  // Factor by which the loop is unrolled, with inner loops jammed together
+  // rather than replicated. Null if the loop is not unrolled-and-jammed.
+  mlir::IntegerAttr unroll_and_jam() const;
 };
 
 // An attribute that specifies how a value is stored in a buffer.
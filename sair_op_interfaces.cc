@@ -619,6 +619,14 @@ void ComputeOpInstance::SetStorage(int result, BufferAttr storage) {
   SetDecisions(new_decisions);
 }
 
+void ComputeOpInstance::SetStorage(llvm::ArrayRef<BufferAttr> storage) {
+  assert(storage.size() == num_results());
+  llvm::SmallVector<mlir::Attribute> array(storage.begin(), storage.end());
+  mlir::ArrayAttr array_attr = mlir::ArrayAttr::get(context(), array);
+  SetDecisions(
+      MapStorage([=](mlir::ArrayAttr) { return array_attr; })(GetDecisions()));
+}
+
 ComputeOp ComputeOpInstance::GetComputeOp() const {
   return llvm::cast<ComputeOp>(GetDuplicatedOp());
 }
@@ -401,6 +401,9 @@ class ComputeOpInstance : public OpInstance {
   // Set storage information for the given result.
   void SetStorage(int result, BufferAttr storage);
 
+  // Sets storage information for all results at once.
+  void SetStorage(llvm::ArrayRef<BufferAttr> storage);
+
   // LLVM-style RTTI infrastructure.
   static bool classof(const OpInstance &op) {
     return op.is_copy() || llvm::isa<ComputeOp>(op.getOperation());
@@ -29,6 +29,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/SMLoc.h"
@@ -57,6 +58,10 @@
 #include "storage.h"
 #include "util.h"
 
+#define DEBUG_TYPE "sair-ops"
+
+STATISTIC(NumProgramsVerified, "Number of sair.program operations verified");
+
 namespace sair {
 
 namespace {
@@ -1570,6 +1575,7 @@ void SairProgramOp::print(mlir::OpAsmPrinter &printer) {
 // all its non-terminator ops are Sair ops, and the correctness of lowering
 // attributes that operate across operations: buffer, sequence and loop_nest.
 mlir::LogicalResult SairProgramOp::verify() {
+  ++NumProgramsVerified;
   SairProgramOp program = *this;
   mlir::Block *body = &program.getBody().front();
   for (mlir::Operation &nested_operation : *body) {
@@ -1832,7 +1838,8 @@ static mlir::ArrayAttr ComposeInstances(MappingAttr mapping,
   auto map_loop = [=](LoopAttr loop) {
     MappingExpr new_iter =
         loop.iter().SubstituteDims(mapping.Dimensions()).Canonicalize();
-    return LoopAttr::get(loop.name(), new_iter, loop.unroll(), context);
+    return LoopAttr::get(loop.name(), new_iter, loop.unroll(),
+                         loop.unroll_and_jam(), context);
   };
   return MkArrayAttrMapper(MapLoopNest(MkArrayAttrMapper<LoopAttr>(map_loop)))(
       instances);
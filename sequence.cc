@@ -16,8 +16,11 @@
 
 #include <algorithm>
 #include <limits>
-#include <map>
 
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Support/Debug.h"
 #include "loop_nest.h"
@@ -28,6 +31,8 @@
 #define DEBUG_TYPE "sair-sequence"
 #define DBGS(X) llvm::dbgs() << "[" DEBUG_TYPE "]"
 
+STATISTIC(NumSequenceAnalyses, "Number of sequence analyses computed");
+
 namespace sair {
 
 namespace {
@@ -68,7 +73,6 @@ class ConcreteOpGraph {
   llvm::SmallDenseMap<OpTy, llvm::SetVector<OpTy>> adjacency_;
 };
 
-using ComputeOpGraph = ConcreteOpGraph<ComputeOpInstance>;
 using OpGraph = ConcreteOpGraph<OpInstance>;
 
 // A pseudo-container class implementing a DFS postorder iterator of a graph of
@@ -228,17 +232,6 @@ class DFSPostorderTraversal {
   const ConcreteOpGraph<OpTy> &graph_;
 };
 
-// Updates `graph` to remove self-dependencies.
-void RemoveSelfDependencies(ComputeOpGraph &graph) {
-  llvm::ArrayRef<ComputeOpInstance> all_ops = graph.keys();
-
-  // Since we are working with predecessor graphs, drop self-links because the
-  // op is not expected to be its own predecessor.
-  for (const ComputeOpInstance &op : all_ops) {
-    graph[op].remove(op);
-  }
-}
-
 llvm::SetVector<ComputeOpInstance> ComputeOpFrontier(
     const OpInstance &op, ArrayRef<OpInstance> ignore = {}) {
   // The frontier is computed recursively as we don't expect long chains of
@@ -305,6 +298,7 @@ std::optional<SequenceAnalysis> SequenceAnalysis::Create(
 
 mlir::LogicalResult SequenceAnalysis::Init(SairProgramOp program_op,
                                            bool report_errors) {
+  ++NumSequenceAnalyses;
   return ComputeDefaultSequence(program_op, report_errors);
 }
 
@@ -571,37 +565,8 @@ bool FindImplicitlySequencedUseDefChain(
   return false;
 }
 
-// Returns an iterator range pointing to `sequenced_ops` of all operations
-// sequenced before the given one, in their relative order. All operations are
-// given a relative order even if they don't have a sequence attribute attached.
-// The sequence number returned in this iteration may differ from that of the
-// sequence attribute if the Sair program hasn't been canonicalized.
-static llvm::iterator_range<
-    std::multimap<int64_t, ComputeOpInstance>::const_iterator>
-OpsBefore(const std::multimap<int64_t, ComputeOpInstance> &sequenced_ops,
-          ComputeOpInstance op) {
-  DecisionsAttr decisions = op.GetDecisions();
-  if (decisions.sequence() == nullptr) {
-    return llvm::make_range(sequenced_ops.end(), sequenced_ops.end());
-  }
-
-  int64_t sequence_number = decisions.sequence().getInt();
-  return llvm::make_range(sequenced_ops.begin(),
-                          sequenced_ops.lower_bound(sequence_number));
-}
-
 mlir::LogicalResult SequenceAnalysis::ComputeDefaultSequence(
     SairProgramOp program, bool report_errors) {
-  // We use a standard multimap because (a) the sequence numbers can be shared
-  // and (b) we need a deterministic increasing order that is provided by this
-  // map and not provided by hash table-based maps.
-  std::multimap<int64_t, ComputeOpInstance> initial_sequence;
-  program.WalkComputeOpInstances([&](const ComputeOpInstance &op) {
-    DecisionsAttr decisions = op.GetDecisions();
-    if (decisions.sequence() == nullptr) return;
-    initial_sequence.emplace(decisions.sequence().getInt(), op);
-  });
-
   // This shouldn't fail as long as we control use-def chain order in the input
   // IR. When we don't, this could fail on unexpected use-def cycles, i.e.
   // cycles that are not caused by "fby", and should be reported back to the
@@ -610,66 +575,149 @@ mlir::LogicalResult SequenceAnalysis::ComputeDefaultSequence(
     return mlir::failure();
   }
 
-  ComputeOpGraph predecessors;
+  // Number compute operations in the order of the walk, which is also the
+  // order in which traversal roots are picked below.
+  llvm::SmallVector<ComputeOpInstance> ops;
+  llvm::DenseMap<ComputeOpInstance, int> op_indices;
   program.WalkComputeOpInstances([&](const ComputeOpInstance &op) {
-    // Put the op in the adjacency list even if it has no predecessors.
-    predecessors.insert(op);
+    op_indices.try_emplace(op, ops.size());
+    ops.push_back(op);
+  });
 
-    // Add all predecessor compute ops due to use-def chains. Note that we add
-    // only the frontier since we will traverse the entire graph in DFS manner,
-    // so there's no need to compute the entire slice here.
-    predecessors[op] = ComputeOpFrontier(op, fby_ops_to_cut_);
+  // Add all predecessor compute ops due to use-def chains. Note that we add
+  // only the frontier since we will traverse the entire graph in DFS manner,
+  // so there's no need to compute the entire slice here. Since we are working
+  // with predecessor graphs, drop self-links because the op is not expected to
+  // be its own predecessor.
+  llvm::SmallVector<llvm::SmallVector<int, 4>> use_def_predecessors(
+      ops.size());
+  for (auto [index, op] : llvm::enumerate(ops)) {
+    for (const ComputeOpInstance &predecessor :
+         ComputeOpFrontier(op, fby_ops_to_cut_)) {
+      if (predecessor == op) continue;
+      use_def_predecessors[index].push_back(op_indices.lookup(predecessor));
+    }
+  }
 
-    // Add all ops with smaller sequence numbers as known predecessors.
-    auto range = llvm::make_second_range(OpsBefore(initial_sequence, op));
-    predecessors[op].insert(range.begin(), range.end());
-  });
+  // Sort explicitly sequenced ops by sequence number. The sort is stable as
+  // sequence numbers can be shared and we need a deterministic order. All ops
+  // with smaller sequence numbers are known predecessors of a sequenced op.
+  // Rather than materializing these edges, which is quadratic in the number of
+  // ops, only record how many of the sorted ops precede each op.
+  llvm::SmallVector<std::pair<int64_t, int>> sequenced_ops;
+  for (auto [index, op] : llvm::enumerate(ops)) {
+    DecisionsAttr decisions = op.GetDecisions();
+    if (decisions.sequence() == nullptr) continue;
+    sequenced_ops.emplace_back(decisions.sequence().getInt(), index);
+  }
+  llvm::stable_sort(sequenced_ops, llvm::less_first());
+  llvm::SmallVector<int> num_sequenced_predecessors(ops.size(), 0);
+  for (auto [sequence_number, index] : sequenced_ops) {
+    auto it = llvm::partition_point(sequenced_ops, [&](const auto &entry) {
+      return entry.first < sequence_number;
+    });
+    num_sequenced_predecessors[index] =
+        std::distance(sequenced_ops.begin(), it);
+  }
 
-  RemoveSelfDependencies(predecessors);
+  // An op being visited, along with the position of the next use-def
+  // predecessor to consider.
+  struct Frame {
+    int op;
+    int next_use_def_predecessor;
+  };
+  llvm::BitVector visited(ops.size());
+  llvm::BitVector on_stack(ops.size());
+  // Ops are never unmarked as visited so the first unvisited sequenced op only
+  // moves forward and can be shared by all ops.
+  int first_unvisited_sequenced = 0;
+
+  // Returns the first unvisited predecessor of the op in `frame`, considering
+  // use-def predecessors first and sequenced predecessors by increasing
+  // sequence number next. Returns -1 if all predecessors are visited.
+  auto next_predecessor = [&](Frame &frame) -> int {
+    llvm::ArrayRef<int> predecessors = use_def_predecessors[frame.op];
+    for (int e = predecessors.size(); frame.next_use_def_predecessor < e;
+         ++frame.next_use_def_predecessor) {
+      int predecessor = predecessors[frame.next_use_def_predecessor];
+      if (!visited.test(predecessor)) return predecessor;
+    }
+    int num_sequenced_ops = sequenced_ops.size();
+    while (first_unvisited_sequenced < num_sequenced_ops &&
+           visited.test(sequenced_ops[first_unvisited_sequenced].second)) {
+      ++first_unvisited_sequenced;
+    }
+    if (first_unvisited_sequenced < num_sequenced_predecessors[frame.op]) {
+      return sequenced_ops[first_unvisited_sequenced].second;
+    }
+    return -1;
+  };
 
   // Walk the predecessor graph in DFS post-order, meaning that we will visit a
   // compute op after visiting all of its predecessors, and assign new sequence
-  // numbers.
-  DFSPostorderTraversal<ComputeOpInstance> traversal(predecessors);
-  compute_ops_.reserve(predecessors.keys().size());
-  for (auto it = traversal.begin(), eit = traversal.end(); it != eit; ++it) {
-    if (*it != nullptr) {
-      op_to_sequence_number_.try_emplace(*it, compute_ops_.size());
-      compute_ops_.push_back(*it);
-      continue;
-    }
+  // numbers. Maintain an explicit stack to avoid recursive functions on a
+  // potentially large number of ops.
+  compute_ops_.reserve(ops.size());
+  llvm::SmallVector<Frame> dfs_stack;
+  for (int root = 0, e = ops.size(); root < e; ++root) {
+    if (visited.test(root)) continue;
+    dfs_stack.push_back({root, 0});
+    on_stack.set(root);
+    while (!dfs_stack.empty()) {
+      int predecessor = next_predecessor(dfs_stack.back());
+      if (predecessor < 0) {
+        int current = dfs_stack.pop_back_val().op;
+        on_stack.reset(current);
+        visited.set(current);
+        op_to_sequence_number_.try_emplace(ops[current], compute_ops_.size());
+        compute_ops_.push_back(ops[current]);
+        continue;
+      }
+      if (!on_stack.test(predecessor)) {
+        dfs_stack.push_back({predecessor, 0});
+        on_stack.set(predecessor);
+        continue;
+      }
 
-    // If the traversal hits a cycle (indicated by the iterator pointing to
-    // nullptr), this means order of operations implied by use-def chains
-    // contradicts that implied by sequence attributes. That is, a use of a
-    // value is sequenced before the value is defined. This situation is
-    // slightly different from the pure use-def cycle detected above.
-    auto cycle = llvm::to_vector<4>(it.FindCycleOnStack());
-    LLVM_DEBUG({
-      DBGS() << "unexpected cycle detected\n";
-      for (const ComputeOpInstance &cycle_op : cycle)
-        DBGS() << cycle_op.getOperation() << "\n";
-    });
+      // If the traversal hits a cycle, this means order of operations implied
+      // by use-def chains contradicts that implied by sequence attributes.
+      // That is, a use of a value is sequenced before the value is defined.
+      // This situation is slightly different from the pure use-def cycle
+      // detected above.
+      auto cycle_begin = llvm::find_if(dfs_stack, [&](const Frame &frame) {
+        return frame.op == predecessor;
+      });
+      llvm::SmallVector<ComputeOpInstance, 4> cycle;
+      for (auto it = cycle_begin; it != dfs_stack.end(); ++it) {
+        cycle.push_back(ops[it->op]);
+      }
+      LLVM_DEBUG({
+        DBGS() << "unexpected cycle detected\n";
+        for (const ComputeOpInstance &cycle_op : cycle)
+          DBGS() << cycle_op.getOperation() << "\n";
+      });
 
-    if (!report_errors) return mlir::failure();
-    cycle.push_back(cycle.front());
-    mlir::InFlightDiagnostic diag =
-        cycle.back().EmitError()
-        << "operation sequencing contradicts use-def chains";
-    for (int i = cycle.size() - 2; i >= 0; --i) {
-      llvm::SmallVector<OpInstance> stack;
-      if (FindImplicitlySequencedUseDefChain(cycle[i + 1], cycle[i], stack)) {
-        for (OpInstance stack_op : llvm::drop_begin(stack)) {
-          stack_op.AttachNote(diag) << "implicitly sequenced operation";
+      if (!report_errors) return mlir::failure();
+      cycle.push_back(cycle.front());
+      mlir::InFlightDiagnostic diag =
+          cycle.back().EmitError()
+          << "operation sequencing contradicts use-def chains";
+      for (int i = cycle.size() - 2; i >= 0; --i) {
+        llvm::SmallVector<OpInstance> stack;
+        if (FindImplicitlySequencedUseDefChain(cycle[i + 1], cycle[i],
+                                               stack)) {
+          for (OpInstance stack_op : llvm::drop_begin(stack)) {
+            stack_op.AttachNote(diag) << "implicitly sequenced operation";
+          }
+          cycle[i].AttachNote(diag)
+              << "sequenceable operation sequenced by use-def";
+        } else {
+          cycle[i].AttachNote(diag) << "sequenceable operation";
         }
-        cycle[i].AttachNote(diag)
-            << "sequenceable operation sequenced by use-def";
-      } else {
-        cycle[i].AttachNote(diag) << "sequenceable operation";
       }
-    }
 
-    return diag;
+      return diag;
+    }
   }
   return mlir::success();
 }
@@ -97,6 +97,12 @@ class SequenceAnalysis {
   // their "sequence" attributes.
   void AssignInferred() const;
 
+  // Returns the position of `op` in Ops(). Compute operations are sequenced in
+  // the increasing order of their position.
+  int64_t SequenceNumber(const ComputeOpInstance &op) const {
+    return ExplicitSequenceNumber(op);
+  }
+
   // Returns true if `first` is known to be sequenced before `second`, false
   // otherwise. Note that this currently relies on the default implicit order of
   // sequenced ops so even the ops that do not need to be sequenced in the
@@ -14,11 +14,22 @@
 
 #include "storage.h"
 
+#include <limits>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
 #include "loop_nest.h"
 #include "sair_dialect.h"
 #include "sequence.h"
 
+#define DEBUG_TYPE "sair-storage"
+
+STATISTIC(NumStorageAnalyses, "Number of storage analyses computed");
+STATISTIC(NumBufferShapesUnified,
+          "Number of buffer accesses unified with buffer shapes");
+
 namespace sair {
 
 // Returns the layout of from_memref or to_memref operation value.
@@ -67,6 +78,18 @@ StorageAnalysis::StorageAnalysis(mlir::Operation *operation)
   (void)result;
 }
 
+StorageAnalysis::StorageAnalysis(mlir::Operation *operation,
+                                 mlir::AnalysisManager &analysis_manager)
+    : StorageAnalysis(operation->getContext()) {
+  mlir::LogicalResult result =
+      Init(cast<SairProgramOp>(operation),
+           analysis_manager.getAnalysis<SequenceAnalysis>(),
+           analysis_manager.getAnalysis<LoopFusionAnalysis>(),
+           analysis_manager.getAnalysis<IterationSpaceAnalysis>());
+  assert(mlir::succeeded(result));
+  (void)result;
+}
+
 std::optional<StorageAnalysis> StorageAnalysis::Create(SairProgramOp program) {
   StorageAnalysis analysis(program.getContext());
   if (mlir::failed(analysis.Init(program))) {
@@ -172,6 +195,7 @@ static mlir::LogicalResult UnifyBufferShape(
     mlir::StringAttr buffer_name, const OpInstance &op, MappingAttr layout,
     const IterationSpace &op_iter_space,
     const LoopFusionAnalysis &loop_analysis, Buffer &buffer) {
+  ++NumBufferShapesUnified;
   mlir::MLIRContext *context = op.context();
   int iter_space_size = op_iter_space.mapping().size();
   LoopNest op_loop_nest = loop_analysis.GetLoopNest(op_iter_space.loop_names());
@@ -404,11 +428,17 @@ mlir::LogicalResult StorageAnalysis::ComputeValueStorages(
 }
 
 mlir::LogicalResult StorageAnalysis::Init(SairProgramOp program) {
-  // TODO(b/181938550): use cached analysis.
   SequenceAnalysis sequence_analysis(program);
   LoopFusionAnalysis fusion_analysis(program, &sequence_analysis);
   IterationSpaceAnalysis iteration_spaces(program);
+  return Init(program, sequence_analysis, fusion_analysis, iteration_spaces);
+}
 
+mlir::LogicalResult StorageAnalysis::Init(
+    SairProgramOp program, const SequenceAnalysis &sequence_analysis,
+    const LoopFusionAnalysis &fusion_analysis,
+    const IterationSpaceAnalysis &iteration_spaces) {
+  ++NumStorageAnalyses;
   if (mlir::failed(DeclareBuffers(program, iteration_spaces, fusion_analysis,
                                   buffers_))) {
     return mlir::failure();
@@ -538,10 +568,26 @@ static mlir::LogicalResult UpdateStorage(
   return mlir::success();
 }
 
+void StorageAnalysis::MergeStorages(
+    llvm::ArrayRef<std::pair<ResultInstance, ValueStorage>> new_storages,
+    const LoopFusionAnalysis &fusion_analysis,
+    const IterationSpaceAnalysis &iteration_spaces) {
+  AssertSuccess(SetStorages(new_storages, fusion_analysis, iteration_spaces));
+}
+
 mlir::LogicalResult StorageAnalysis::SetStorage(
     ResultInstance value, ValueStorage storage,
     const LoopFusionAnalysis &fusion_analysis,
     const IterationSpaceAnalysis &iteration_spaces) {
+  std::pair<ResultInstance, ValueStorage> new_storage(value,
+                                                      std::move(storage));
+  return SetStorages(new_storage, fusion_analysis, iteration_spaces);
+}
+
+mlir::LogicalResult StorageAnalysis::SetStorages(
+    llvm::ArrayRef<std::pair<ResultInstance, ValueStorage>> new_storages,
+    const LoopFusionAnalysis &fusion_analysis,
+    const IterationSpaceAnalysis &iteration_spaces) {
   llvm::SmallVector<ResultInstance> work_list;
 
   // Merge storage information for a value with existing information. Fails and
@@ -556,9 +602,11 @@ mlir::LogicalResult StorageAnalysis::SetStorage(
                          storage, buffers_);
   };
 
-  if (mlir::failed(update_storage(value, storage))) return mlir::failure();
+  for (const auto &[value, storage] : new_storages) {
+    if (mlir::failed(update_storage(value, storage))) return mlir::failure();
+  }
 
-  // Propagate storage information.
+  // Propagate storage information once all new storages are merged.
   while (!work_list.empty()) {
     ResultInstance value = work_list.pop_back_val();
     ValueStorage storage = value_storages_[value];
@@ -782,9 +830,83 @@ static mlir::LogicalResult VerifyCommunicationVolume(
   return mlir::success();
 }
 
-// Verifies that `buffer` is not written to by operations other that
-// `allowed_write` between `from` and `to`. `allowed_write` may be null in the
-// case were no write is allowed between `from` and `to`.
+namespace {
+
+// Writes to a buffer, indexed by their position in the sequence of compute
+// operations. Looking for writes that may overwrite a value then only requires
+// a binary search instead of a traversal of all the writes of the buffer.
+class SequencedWrites {
+ public:
+  struct Write {
+    // Sequence number of the writing operation.
+    int64_t position;
+    // Position of the write in Buffer::writes().
+    int index;
+    ComputeOpInstance op;
+    int result;
+  };
+
+  SequencedWrites(const Buffer &buffer,
+                  const IterationSpaceAnalysis &iteration_spaces,
+                  const SequenceAnalysis &sequence_analysis);
+
+  // Returns all writes, sorted by position.
+  llvm::ArrayRef<Write> all() const { return writes_; }
+
+  // Returns the writes nested in `loop`, sorted by position.
+  llvm::ArrayRef<Write> NestedIn(mlir::StringAttr loop) const {
+    auto it = loop_writes_.find(loop);
+    if (it == loop_writes_.end()) return {};
+    return it->second;
+  }
+
+  // Returns the writes of `writes` with a position strictly smaller than
+  // `position`. `writes` must be sorted by position.
+  static llvm::ArrayRef<Write> Before(llvm::ArrayRef<Write> writes,
+                                      int64_t position) {
+    auto it = llvm::partition_point(
+        writes, [&](const Write &write) { return write.position < position; });
+    return writes.take_front(std::distance(writes.begin(), it));
+  }
+
+  // Returns the writes of `writes` with a position strictly greater than
+  // `position`. `writes` must be sorted by position.
+  static llvm::ArrayRef<Write> After(llvm::ArrayRef<Write> writes,
+                                     int64_t position) {
+    auto it = llvm::partition_point(
+        writes, [&](const Write &write) { return write.position <= position; });
+    return writes.drop_front(std::distance(writes.begin(), it));
+  }
+
+ private:
+  llvm::SmallVector<Write> writes_;
+  llvm::DenseMap<mlir::Attribute, llvm::SmallVector<Write>> loop_writes_;
+};
+
+SequencedWrites::SequencedWrites(const Buffer &buffer,
+                                 const IterationSpaceAnalysis &iteration_spaces,
+                                 const SequenceAnalysis &sequence_analysis) {
+  for (auto [index, write] : llvm::enumerate(buffer.writes())) {
+    auto [op, result] = write;
+    writes_.push_back({sequence_analysis.SequenceNumber(op),
+                       static_cast<int>(index), op, result});
+  }
+  llvm::stable_sort(writes_, [](const Write &lhs, const Write &rhs) {
+    return lhs.position < rhs.position;
+  });
+
+  for (const Write &write : writes_) {
+    for (mlir::StringAttr loop : iteration_spaces.Get(write.op).loop_names()) {
+      loop_writes_[loop].push_back(write);
+    }
+  }
+}
+
+}  // namespace
+
+// Verifies that the buffer `writes` refers to is not written to by operations
+// other than `allowed_write` between `from` and `to`. `allowed_write` may be
+// null in the case where no write is allowed between `from` and `to`.
 //
 // If `from` is in loop nest [A, B] and `to` is in loop nest [A, C] where A, B
 // and C are lists of loops with loops of B and C distinct, we consider that
@@ -798,24 +920,68 @@ static mlir::LogicalResult VerifyCommunicationVolume(
 // * If there is a write operation after `to` that is nested in at least one
 //   loop of C. This corresponds to the case where the value is overwritten in
 //   the loop nest where it is used.
+//
+// Only the writes between `from` and `to` and the writes nested in the first
+// loop of B or C are inspected, using `writes` to find them.
 static mlir::LogicalResult VerifyNoWriteBetween(
-    mlir::StringAttr buffer_name, const Buffer &buffer,
+    mlir::StringAttr buffer_name, const SequencedWrites &writes,
     const ProgramPoint &from, const ProgramPoint &to, MappingAttr layout,
     const ComputeOpInstance &allowed_write,
     const IterationSpaceAnalysis &iteration_spaces,
     const StorageAnalysis &storage_analysis,
     const SequenceAnalysis &sequence_analysis) {
+  using Write = SequencedWrites::Write;
   int num_common_loops = from.NumCommonLoops(to);
-  for (auto [write_op, write_pos] : buffer.writes()) {
-    const IterationSpace &iter_space = iteration_spaces.Get(write_op);
-    if (write_op == allowed_write) continue;
 
-    // Check if the write occurs before `from`.
-    if (sequence_analysis.IsAfter(from, write_op)) {
+  // Writes positioned in [first, last] occur between `from` and `to`. Writes
+  // before `first` occur before `from` and writes after `last` occur after
+  // `to`.
+  int64_t first, last;
+  if (from.operation() == nullptr) {
+    first = from.direction() == Direction::kBefore
+                ? std::numeric_limits<int64_t>::min()
+                : std::numeric_limits<int64_t>::max();
+  } else {
+    first = sequence_analysis.SequenceNumber(from.operation());
+    if (from.direction() == Direction::kAfter) ++first;
+  }
+  if (to.operation() == nullptr) {
+    last = to.direction() == Direction::kAfter
+               ? std::numeric_limits<int64_t>::max()
+               : std::numeric_limits<int64_t>::min();
+  } else {
+    last = sequence_analysis.SequenceNumber(to.operation());
+    if (to.direction() == Direction::kBefore) --last;
+  }
+
+  // Retain the overwriting write that comes first in Buffer::writes() so that
+  // diagnostics do not depend on the order in which writes are inspected.
+  const Write *overwrite = nullptr;
+  auto record_overwrite = [&](const Write &write) {
+    if (overwrite == nullptr || write.index < overwrite->index) {
+      overwrite = &write;
+    }
+  };
+
+  llvm::ArrayRef<Write> not_before_from = writes.all().drop_front(
+      SequencedWrites::Before(writes.all(), first).size());
+  llvm::ArrayRef<Write> between = not_before_from.drop_back(
+      SequencedWrites::After(not_before_from, last).size());
+  for (const Write &write : between) {
+    if (write.op != allowed_write) record_overwrite(write);
+  }
+
+  // Writes before `from` nested in the first loop of B.
+  if (from.loop_nest().size() > num_common_loops) {
+    llvm::ArrayRef<Write> nested =
+        writes.NestedIn(from.loop_nest()[num_common_loops]);
+    for (const Write &write : SequencedWrites::Before(nested, first)) {
+      if (write.op == allowed_write) continue;
+      const IterationSpace &iter_space = iteration_spaces.Get(write.op);
       int write_common_loops = iter_space.NumCommonLoops(from.loop_nest());
       if (write_common_loops <= num_common_loops) continue;
       const ValueStorage &value_storage =
-          storage_analysis.GetStorage(write_op.Result(write_pos));
+          storage_analysis.GetStorage(write.op.Result(write.result));
       // We consider that there is no overwrite if the write if before `from`
       // and layouts are the same.
       if (layout == nullptr || value_storage.layout() == nullptr ||
@@ -823,37 +989,52 @@ static mlir::LogicalResult VerifyNoWriteBetween(
               layout.ResizeUseDomain(write_common_loops)) {
         continue;
       }
-    } else if (sequence_analysis.IsBefore(to, write_op)) {
+      record_overwrite(write);
+    }
+  }
+
+  // Writes after `to` nested in the first loop of C.
+  if (to.loop_nest().size() > num_common_loops) {
+    llvm::ArrayRef<Write> nested =
+        writes.NestedIn(to.loop_nest()[num_common_loops]);
+    nested = nested.drop_front(SequencedWrites::Before(nested, first).size());
+    for (const Write &write : SequencedWrites::After(nested, last)) {
+      if (write.op == allowed_write) continue;
+      const IterationSpace &iter_space = iteration_spaces.Get(write.op);
       int write_common_loops = iter_space.NumCommonLoops(to.loop_nest());
       if (write_common_loops <= num_common_loops) continue;
+      record_overwrite(write);
     }
+  }
 
-    mlir::InFlightDiagnostic diag =
-        write_op.EmitError() << "operation overwrites a value stored in buffer "
-                             << buffer_name << " before it is used";
-    if (from.operation() == nullptr) {
-      diag.attachNote(write_op.program()->getLoc())
-          << "value stored before entering sair program";
-    } else {
-      from.operation().AttachNote(diag) << "value stored here";
-    }
+  if (overwrite == nullptr) return mlir::success();
 
-    if (to.operation() == nullptr) {
-      diag.attachNote(write_op.program()->getLoc())
-          << "value used after exiting sair program";
-    } else {
-      to.operation().AttachNote(diag) << "value used here";
-    }
-    return mlir::failure();
+  ComputeOpInstance write_op = overwrite->op;
+  mlir::InFlightDiagnostic diag =
+      write_op.EmitError() << "operation overwrites a value stored in buffer "
+                           << buffer_name << " before it is used";
+  if (from.operation() == nullptr) {
+    diag.attachNote(write_op.program()->getLoc())
+        << "value stored before entering sair program";
+  } else {
+    from.operation().AttachNote(diag) << "value stored here";
   }
-  return mlir::success();
+
+  if (to.operation() == nullptr) {
+    diag.attachNote(write_op.program()->getLoc())
+        << "value used after exiting sair program";
+  } else {
+    to.operation().AttachNote(diag) << "value used here";
+  }
+  return mlir::failure();
 }
 
 // Verifies that `value` storage is not overwritten by an operation between the
-// operation that stores the value in `buffer` and `use`.
+// operation that stores the value in the buffer `writes` refers to and `use`.
 static mlir::LogicalResult VerifyValueNotOverwritten(
-    mlir::StringAttr buffer_name, const Buffer &buffer, ResultInstance value,
-    ProgramPoint use, const LoopFusionAnalysis &fusion_analysis,
+    mlir::StringAttr buffer_name, const SequencedWrites &writes,
+    ResultInstance value, ProgramPoint use,
+    const LoopFusionAnalysis &fusion_analysis,
     const IterationSpaceAnalysis &iteration_spaces,
     const StorageAnalysis &storage_analysis,
     const SequenceAnalysis &sequence_analysis) {
@@ -879,7 +1060,7 @@ static mlir::LogicalResult VerifyValueNotOverwritten(
                              iter_space.loop_names());
       const ValueStorage &storage = storage_analysis.GetStorage(value);
       if (mlir::failed(VerifyNoWriteBetween(
-              buffer_name, buffer, def_point, use_point, storage.layout(),
+              buffer_name, writes, def_point, use_point, storage.layout(),
               allowed_write, iteration_spaces, storage_analysis,
               sequence_analysis))) {
         return mlir::failure();
@@ -901,7 +1082,7 @@ static mlir::LogicalResult VerifyValueNotOverwritten(
     } else if (auto from_memref = dyn_cast<SairFromMemRefOp>(concrete_op)) {
       MappingAttr layout = FromToMemRefLayout(from_memref, iter_space);
       ProgramPoint before_program(defining_op.program(), Direction::kBefore);
-      if (mlir::failed(VerifyNoWriteBetween(buffer_name, buffer, before_program,
+      if (mlir::failed(VerifyNoWriteBetween(buffer_name, writes, before_program,
                                             use_point, layout, allowed_write,
                                             iteration_spaces, storage_analysis,
                                             sequence_analysis))) {
@@ -964,13 +1145,14 @@ mlir::LogicalResult VerifyValuesNotOverwritten(
   // where a value is written and the moment where a value is read.
   for (const auto &[name_attr, buffer] : storage_analysis.buffers()) {
     auto buffer_name = name_attr.cast<mlir::StringAttr>();
+    SequencedWrites writes(buffer, iteration_spaces, sequence_analysis);
     for (auto [op, operand_pos] : buffer.reads()) {
       const IterationSpace &iter_space = iteration_spaces.Get(op);
       auto operand = op.Operand(operand_pos).GetValue();
       if (!operand.has_value()) continue;
       ProgramPoint use_point(op, Direction::kBefore, iter_space.loop_names());
       if (mlir::failed(VerifyValueNotOverwritten(
-              buffer_name, buffer, *operand, use_point, fusion_analysis,
+              buffer_name, writes, *operand, use_point, fusion_analysis,
               iteration_spaces, storage_analysis, sequence_analysis))) {
         return mlir::failure();
       }
@@ -989,7 +1171,7 @@ mlir::LogicalResult VerifyValuesNotOverwritten(
     auto value = OperandInstance(to_memref.Value(), op_instance).GetValue();
     if (!value.has_value()) continue;
     if (mlir::failed(VerifyValueNotOverwritten(
-            buffer_name, buffer, *value, after_program, fusion_analysis,
+            buffer_name, writes, *value, after_program, fusion_analysis,
             iteration_spaces, storage_analysis, sequence_analysis))) {
       return mlir::failure();
     }
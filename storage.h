@@ -142,13 +142,20 @@ MappingAttr CommunicationVolume(int value_rank,
                                 const IterationSpace &def_iter_space,
                                 const IterationSpace &use_iter_space);
 
-// Computes buffers metadata and storage information for each value.
+// Computes buffers metadata and storage information for each value. The
+// analysis is not updated incrementally: passes that change storage or loop
+// nests must not preserve it.
 class StorageAnalysis {
  public:
   // Creates and populates the analysis. `operation` must be a sair.program
   // operation. Asserts that the analysis succeeded.
   explicit StorageAnalysis(mlir::Operation *operation);
 
+  // Same as above, but reuses the sequence, loop fusion and iteration space
+  // analyses cached by `analysis_manager` instead of recomputing them.
+  StorageAnalysis(mlir::Operation *operation,
+                  mlir::AnalysisManager &analysis_manager);
+
   // Creates and populates the analysis. Returns `nullopt` and emits an error if
   // the analysis fails because storage attributes are invalid.
   static std::optional<StorageAnalysis> Create(SairProgramOp program);
@@ -181,6 +188,15 @@ class StorageAnalysis {
                     const LoopFusionAnalysis &fusion_analysis,
                     const IterationSpaceAnalysis &iteration_spaces);
 
+  // Merges storage information for several values before propagating it to
+  // other values in a single pass. This is equivalent to calling MergeStorage
+  // on each value when new storages only complete information that is already
+  // propagated, but avoids propagating through the same values repeatedly.
+  void MergeStorages(
+      llvm::ArrayRef<std::pair<ResultInstance, ValueStorage>> new_storages,
+      const LoopFusionAnalysis &fusion_analysis,
+      const IterationSpaceAnalysis &iteration_spaces);
+
   // Returns a fresh buffer name. May be called multiple times without
   // invalidating the analysis.
   mlir::StringAttr GetFreshBufferName();
@@ -208,6 +224,10 @@ class StorageAnalysis {
 
   // Populates the analysis.
   mlir::LogicalResult Init(SairProgramOp program);
+  mlir::LogicalResult Init(SairProgramOp program,
+                           const SequenceAnalysis &sequence_analysis,
+                           const LoopFusionAnalysis &fusion_analysis,
+                           const IterationSpaceAnalysis &iteration_spaces);
 
   // Fills value_storages_.
   mlir::LogicalResult ComputeValueStorages(
@@ -221,6 +241,14 @@ class StorageAnalysis {
       const LoopFusionAnalysis &fusion_analysis,
       const IterationSpaceAnalysis &iteration_spaces);
 
+  // Sets the storage of several values and propagates the information to other
+  // values once all storages are set. Emits an error if a new storage conflicts
+  // with existing storage.
+  mlir::LogicalResult SetStorages(
+      llvm::ArrayRef<std::pair<ResultInstance, ValueStorage>> new_storages,
+      const LoopFusionAnalysis &fusion_analysis,
+      const IterationSpaceAnalysis &iteration_spaces);
+
   mlir::MLIRContext *context_;
   int next_buffer_id_ = 0;
   llvm::DenseMap<mlir::Attribute, Buffer> buffers_;
@@ -261,3 +261,55 @@ func.func @sequence(%arg0 : f32, %arg1 : index) {
   } : f32
   func.return
 }
+
+// CHECK-LABEL: @common_subexpressions
+func.func @common_subexpressions(%arg0: f32, %arg1: memref<8xf32>) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    %1 = sair.static_range : !sair.static_range<8>
+    %2 = sair.from_scalar %arg1 : !sair.value<(), memref<8xf32>>
+    // CHECK: %[[M0:.*]] = sair.from_memref
+    // CHECK-NOT: sair.from_memref
+    %3 = sair.from_memref %2 memref[d0:%1] {buffer_name = "A"}
+      : #sair.shape<d0:static_range<8>>, memref<8xf32>
+    %4 = sair.from_memref %2 memref[d0:%1] {buffer_name = "A"}
+      : #sair.shape<d0:static_range<8>>, memref<8xf32>
+    // CHECK: %[[C0:.*]] = sair.copy[d0:%{{.*}}] %{{.*}}
+    // CHECK-NOT: sair.copy
+    %5 = sair.copy[d0:%1] %0 : !sair.value<d0:static_range<8>, f32>
+    %6 = sair.copy[d0:%1] %0 : !sair.value<d0:static_range<8>, f32>
+    // CHECK: %[[V0:.*]] = sair.map[d0:%{{.*}}] %[[M0]](d0), %[[C0]](d0)
+    // CHECK:   arith.addf
+    // CHECK:   sair.return
+    %7 = sair.map[d0:%1] %3(d0), %5(d0) {
+      ^bb0(%arg2: index, %arg3: f32, %arg4: f32):
+        %10 = arith.addf %arg3, %arg4 : f32
+        sair.return %10 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32, f32) -> f32
+    // CHECK-NOT: arith.addf
+    %8 = sair.map[d0:%1] %4(d0), %6(d0) {
+      ^bb0(%arg2: index, %arg3: f32, %arg4: f32):
+        %10 = arith.addf %arg3, %arg4 : f32
+        sair.return %10 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32, f32) -> f32
+    // Maps with side effects are not merged.
+    // CHECK: sair.map[d0:%{{.*}}] %[[V0]](d0)
+    // CHECK: call @side_effect
+    // CHECK: sair.map[d0:%{{.*}}] %[[V0]](d0)
+    // CHECK: call @side_effect
+    sair.map[d0:%1] %7(d0) {
+      ^bb0(%arg2: index, %arg3: f32):
+        func.call @side_effect(%arg3) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.map[d0:%1] %8(d0) {
+      ^bb0(%arg2: index, %arg3: f32):
+        func.call @side_effect(%arg3) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.exit
+  }
+  func.return
+}
+
+func.func private @side_effect(f32)
@@ -0,0 +1,464 @@
+// RUN: sair-opt -sair-assign-default-sequence %s | FileCheck %s
+
+// Many explicitly sequenced operations, sequenced in the reverse order of
+// their appearance, each followed by an unsequenced user. Sequenced
+// operations are ordered first by their sequence numbers, then users are
+// ordered after their operands. This test was generated with a script and
+// exercises the traversal of sequenced predecessors with 64 operations.
+
+// CHECK-LABEL: @reverse_sequence
+func.func @reverse_sequence(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 63{{[^0-9]}}
+    %1 = sair.copy %0 {instances = [{sequence = 63}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 64{{[^0-9]}}
+    %2 = sair.copy %1 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 62{{[^0-9]}}
+    %3 = sair.copy %0 {instances = [{sequence = 62}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 65{{[^0-9]}}
+    %4 = sair.copy %3 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 61{{[^0-9]}}
+    %5 = sair.copy %0 {instances = [{sequence = 61}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 66{{[^0-9]}}
+    %6 = sair.copy %5 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 60{{[^0-9]}}
+    %7 = sair.copy %0 {instances = [{sequence = 60}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 67{{[^0-9]}}
+    %8 = sair.copy %7 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 59{{[^0-9]}}
+    %9 = sair.copy %0 {instances = [{sequence = 59}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 68{{[^0-9]}}
+    %10 = sair.copy %9 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 58{{[^0-9]}}
+    %11 = sair.copy %0 {instances = [{sequence = 58}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 69{{[^0-9]}}
+    %12 = sair.copy %11 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 57{{[^0-9]}}
+    %13 = sair.copy %0 {instances = [{sequence = 57}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 70{{[^0-9]}}
+    %14 = sair.copy %13 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 56{{[^0-9]}}
+    %15 = sair.copy %0 {instances = [{sequence = 56}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 71{{[^0-9]}}
+    %16 = sair.copy %15 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 55{{[^0-9]}}
+    %17 = sair.copy %0 {instances = [{sequence = 55}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 72{{[^0-9]}}
+    %18 = sair.copy %17 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 54{{[^0-9]}}
+    %19 = sair.copy %0 {instances = [{sequence = 54}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 73{{[^0-9]}}
+    %20 = sair.copy %19 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 53{{[^0-9]}}
+    %21 = sair.copy %0 {instances = [{sequence = 53}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 74{{[^0-9]}}
+    %22 = sair.copy %21 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 52{{[^0-9]}}
+    %23 = sair.copy %0 {instances = [{sequence = 52}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 75{{[^0-9]}}
+    %24 = sair.copy %23 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 51{{[^0-9]}}
+    %25 = sair.copy %0 {instances = [{sequence = 51}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 76{{[^0-9]}}
+    %26 = sair.copy %25 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 50{{[^0-9]}}
+    %27 = sair.copy %0 {instances = [{sequence = 50}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 77{{[^0-9]}}
+    %28 = sair.copy %27 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 49{{[^0-9]}}
+    %29 = sair.copy %0 {instances = [{sequence = 49}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 78{{[^0-9]}}
+    %30 = sair.copy %29 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 48{{[^0-9]}}
+    %31 = sair.copy %0 {instances = [{sequence = 48}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 79{{[^0-9]}}
+    %32 = sair.copy %31 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 47{{[^0-9]}}
+    %33 = sair.copy %0 {instances = [{sequence = 47}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 80{{[^0-9]}}
+    %34 = sair.copy %33 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 46{{[^0-9]}}
+    %35 = sair.copy %0 {instances = [{sequence = 46}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 81{{[^0-9]}}
+    %36 = sair.copy %35 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 45{{[^0-9]}}
+    %37 = sair.copy %0 {instances = [{sequence = 45}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 82{{[^0-9]}}
+    %38 = sair.copy %37 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 44{{[^0-9]}}
+    %39 = sair.copy %0 {instances = [{sequence = 44}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 83{{[^0-9]}}
+    %40 = sair.copy %39 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 43{{[^0-9]}}
+    %41 = sair.copy %0 {instances = [{sequence = 43}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 84{{[^0-9]}}
+    %42 = sair.copy %41 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 42{{[^0-9]}}
+    %43 = sair.copy %0 {instances = [{sequence = 42}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 85{{[^0-9]}}
+    %44 = sair.copy %43 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 41{{[^0-9]}}
+    %45 = sair.copy %0 {instances = [{sequence = 41}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 86{{[^0-9]}}
+    %46 = sair.copy %45 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 40{{[^0-9]}}
+    %47 = sair.copy %0 {instances = [{sequence = 40}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 87{{[^0-9]}}
+    %48 = sair.copy %47 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 39{{[^0-9]}}
+    %49 = sair.copy %0 {instances = [{sequence = 39}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 88{{[^0-9]}}
+    %50 = sair.copy %49 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 38{{[^0-9]}}
+    %51 = sair.copy %0 {instances = [{sequence = 38}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 89{{[^0-9]}}
+    %52 = sair.copy %51 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 37{{[^0-9]}}
+    %53 = sair.copy %0 {instances = [{sequence = 37}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 90{{[^0-9]}}
+    %54 = sair.copy %53 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 36{{[^0-9]}}
+    %55 = sair.copy %0 {instances = [{sequence = 36}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 91{{[^0-9]}}
+    %56 = sair.copy %55 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 35{{[^0-9]}}
+    %57 = sair.copy %0 {instances = [{sequence = 35}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 92{{[^0-9]}}
+    %58 = sair.copy %57 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 34{{[^0-9]}}
+    %59 = sair.copy %0 {instances = [{sequence = 34}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 93{{[^0-9]}}
+    %60 = sair.copy %59 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 33{{[^0-9]}}
+    %61 = sair.copy %0 {instances = [{sequence = 33}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 94{{[^0-9]}}
+    %62 = sair.copy %61 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 32{{[^0-9]}}
+    %63 = sair.copy %0 {instances = [{sequence = 32}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 95{{[^0-9]}}
+    %64 = sair.copy %63 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 31{{[^0-9]}}
+    %65 = sair.copy %0 {instances = [{sequence = 31}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 96{{[^0-9]}}
+    %66 = sair.copy %65 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 30{{[^0-9]}}
+    %67 = sair.copy %0 {instances = [{sequence = 30}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 97{{[^0-9]}}
+    %68 = sair.copy %67 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 29{{[^0-9]}}
+    %69 = sair.copy %0 {instances = [{sequence = 29}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 98{{[^0-9]}}
+    %70 = sair.copy %69 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 28{{[^0-9]}}
+    %71 = sair.copy %0 {instances = [{sequence = 28}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 99{{[^0-9]}}
+    %72 = sair.copy %71 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 27{{[^0-9]}}
+    %73 = sair.copy %0 {instances = [{sequence = 27}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 100{{[^0-9]}}
+    %74 = sair.copy %73 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 26{{[^0-9]}}
+    %75 = sair.copy %0 {instances = [{sequence = 26}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 101{{[^0-9]}}
+    %76 = sair.copy %75 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 25{{[^0-9]}}
+    %77 = sair.copy %0 {instances = [{sequence = 25}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 102{{[^0-9]}}
+    %78 = sair.copy %77 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 24{{[^0-9]}}
+    %79 = sair.copy %0 {instances = [{sequence = 24}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 103{{[^0-9]}}
+    %80 = sair.copy %79 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 23{{[^0-9]}}
+    %81 = sair.copy %0 {instances = [{sequence = 23}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 104{{[^0-9]}}
+    %82 = sair.copy %81 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 22{{[^0-9]}}
+    %83 = sair.copy %0 {instances = [{sequence = 22}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 105{{[^0-9]}}
+    %84 = sair.copy %83 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 21{{[^0-9]}}
+    %85 = sair.copy %0 {instances = [{sequence = 21}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 106{{[^0-9]}}
+    %86 = sair.copy %85 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 20{{[^0-9]}}
+    %87 = sair.copy %0 {instances = [{sequence = 20}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 107{{[^0-9]}}
+    %88 = sair.copy %87 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 19{{[^0-9]}}
+    %89 = sair.copy %0 {instances = [{sequence = 19}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 108{{[^0-9]}}
+    %90 = sair.copy %89 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 18{{[^0-9]}}
+    %91 = sair.copy %0 {instances = [{sequence = 18}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 109{{[^0-9]}}
+    %92 = sair.copy %91 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 17{{[^0-9]}}
+    %93 = sair.copy %0 {instances = [{sequence = 17}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 110{{[^0-9]}}
+    %94 = sair.copy %93 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 16{{[^0-9]}}
+    %95 = sair.copy %0 {instances = [{sequence = 16}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 111{{[^0-9]}}
+    %96 = sair.copy %95 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 15{{[^0-9]}}
+    %97 = sair.copy %0 {instances = [{sequence = 15}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 112{{[^0-9]}}
+    %98 = sair.copy %97 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 14{{[^0-9]}}
+    %99 = sair.copy %0 {instances = [{sequence = 14}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 113{{[^0-9]}}
+    %100 = sair.copy %99 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 13{{[^0-9]}}
+    %101 = sair.copy %0 {instances = [{sequence = 13}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 114{{[^0-9]}}
+    %102 = sair.copy %101 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 12{{[^0-9]}}
+    %103 = sair.copy %0 {instances = [{sequence = 12}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 115{{[^0-9]}}
+    %104 = sair.copy %103 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 11{{[^0-9]}}
+    %105 = sair.copy %0 {instances = [{sequence = 11}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 116{{[^0-9]}}
+    %106 = sair.copy %105 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 10{{[^0-9]}}
+    %107 = sair.copy %0 {instances = [{sequence = 10}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 117{{[^0-9]}}
+    %108 = sair.copy %107 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 9{{[^0-9]}}
+    %109 = sair.copy %0 {instances = [{sequence = 9}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 118{{[^0-9]}}
+    %110 = sair.copy %109 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 8{{[^0-9]}}
+    %111 = sair.copy %0 {instances = [{sequence = 8}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 119{{[^0-9]}}
+    %112 = sair.copy %111 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 7{{[^0-9]}}
+    %113 = sair.copy %0 {instances = [{sequence = 7}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 120{{[^0-9]}}
+    %114 = sair.copy %113 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 6{{[^0-9]}}
+    %115 = sair.copy %0 {instances = [{sequence = 6}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 121{{[^0-9]}}
+    %116 = sair.copy %115 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 5{{[^0-9]}}
+    %117 = sair.copy %0 {instances = [{sequence = 5}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 122{{[^0-9]}}
+    %118 = sair.copy %117 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 4{{[^0-9]}}
+    %119 = sair.copy %0 {instances = [{sequence = 4}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 123{{[^0-9]}}
+    %120 = sair.copy %119 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 3{{[^0-9]}}
+    %121 = sair.copy %0 {instances = [{sequence = 3}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 124{{[^0-9]}}
+    %122 = sair.copy %121 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 2{{[^0-9]}}
+    %123 = sair.copy %0 {instances = [{sequence = 2}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 125{{[^0-9]}}
+    %124 = sair.copy %123 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 1{{[^0-9]}}
+    %125 = sair.copy %0 {instances = [{sequence = 1}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 126{{[^0-9]}}
+    %126 = sair.copy %125 {instances = [{}]} : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 0{{[^0-9]}}
+    %127 = sair.copy %0 {instances = [{sequence = 0}]}
+      : !sair.value<(), f32>
+    // CHECK: %{{.*}} = sair.copy %{{.*}} {
+    // CHECK-SAME: sequence = 127{{[^0-9]}}
+    %128 = sair.copy %127 {instances = [{}]} : !sair.value<(), f32>
+    sair.exit
+  }
+  func.return
+}
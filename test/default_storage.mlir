@@ -209,3 +209,54 @@ func.func @buffer_reuse(%arg0: f32) {
   }
   func.return
 }
+
+// Point-wise values produced and used in the same iteration of a fused loop
+// nest are kept in registers.
+// CHECK-LABEL: @fused_pointwise
+func.func @fused_pointwise(%arg0: f32) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: %[[V0:.*]] = sair.copy
+    // CHECK: storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    %2 = sair.copy[d0:%0, d1:%0] %1 {
+      instances = [{
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<d0>},
+          {name = "loopB", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } : !sair.value<d0:static_range<8> x d1:static_range<8>, f32>
+    // CHECK: %[[V1:.*]] = sair.map[d0:%{{.*}}, d1:%{{.*}}] %[[V0]](d0, d1)
+    // CHECK: storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    %3 = sair.map[d0:%0, d1:%0] %2(d0, d1) attributes {
+      instances = [{
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<d0>},
+          {name = "loopB", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: index, %arg3: f32):
+        %4 = arith.addf %arg3, %arg3 : f32
+        sair.return %4 : f32
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8>>, (f32) -> f32
+    // CHECK: sair.map[d0:%{{.*}}, d1:%{{.*}}] %[[V1]](d0, d1)
+    sair.map[d0:%0, d1:%0] %3(d0, d1) attributes {
+      instances = [{
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<d0>},
+          {name = "loopB", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: index, %arg3: f32):
+        func.call @use(%arg3) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8>>, (f32) -> ()
+    sair.exit
+  }
+  func.return
+}
+
+func.func private @use(f32)
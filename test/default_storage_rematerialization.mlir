@@ -0,0 +1,136 @@
+// RUN: sair-opt %s -sair-assign-default-storage="rematerialization-threshold=1" | FileCheck %s
+
+func.func private @use(f32)
+
+// The producer has no other user, so it is moved to the loops of the user.
+// CHECK-LABEL: @rematerialize
+func.func @rematerialize(%arg0: f32) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: %[[V0:.*]] = sair.map[d0:%{{.*}}] %{{.*}} attributes {
+    // CHECK: instances = [{
+    // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "loopB"}]
+    // CHECK:   sequence = 2
+    // CHECK:   storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    // CHECK: }]
+    %2 = sair.map[d0:%0] %1 attributes {
+      instances = [{
+        sequence = 1,
+        loop_nest = [{name = "loopA", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        %3 = arith.addf %arg2, %arg2 : f32
+        sair.return %3 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    // CHECK: sair.map[d0:%{{.*}}] %[[V0]](d0)
+    // CHECK-NOT: operands
+    sair.map[d0:%0] %2(d0) attributes {
+      instances = [{
+        sequence = 2,
+        loop_nest = [{name = "loopB", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        func.call @use(%arg2) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.exit
+  }
+  func.return
+}
+
+// The producer is still used in its own loops, so a new instance is added for
+// the user in other loops.
+// CHECK-LABEL: @rematerialize_shared
+func.func @rematerialize_shared(%arg0: f32) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: %[[V0:.*]] = sair.map[d0:%{{.*}}] %{{.*}} attributes {
+    // CHECK: instances = [{
+    // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "loopA"}]
+    // CHECK:   storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    // CHECK: }, {
+    // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "loopB"}]
+    // CHECK:   sequence = 3
+    // CHECK:   storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    // CHECK: }]
+    %2 = sair.map[d0:%0] %1 attributes {
+      instances = [{
+        sequence = 1,
+        loop_nest = [{name = "loopA", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        %3 = arith.addf %arg2, %arg2 : f32
+        sair.return %3 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    // CHECK: sair.map[d0:%{{.*}}] %[[V0]](d0)
+    // CHECK-NOT: operands
+    sair.map[d0:%0] %2(d0) attributes {
+      instances = [{
+        sequence = 2,
+        loop_nest = [{name = "loopA", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        func.call @use(%arg2) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    // CHECK: sair.map[d0:%{{.*}}] %[[V0]](d0)
+    // CHECK:   operands = [#sair.instance<0>, #sair.instance<1>]
+    sair.map[d0:%0] %2(d0) attributes {
+      instances = [{
+        sequence = 3,
+        loop_nest = [{name = "loopB", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        func.call @use(%arg2) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.exit
+  }
+  func.return
+}
+
+// CHECK-LABEL: @too_expensive
+func.func @too_expensive(%arg0: f32) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: sair.map[d0:%{{.*}}] %{{.*}} attributes {
+    // CHECK: instances = [{
+    // CHECK:   storage = [{
+    // CHECK:     name = "buffer_0", space = "memory"
+    // CHECK:   }]
+    // CHECK: }]
+    %2 = sair.map[d0:%0] %1 attributes {
+      instances = [{
+        sequence = 1,
+        loop_nest = [{name = "loopA", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        %3 = arith.addf %arg2, %arg2 : f32
+        %4 = arith.mulf %3, %3 : f32
+        sair.return %4 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    // CHECK: sair.map[d0:%{{.*}}] %{{.*}}(d0)
+    // CHECK-NOT: operands
+    sair.map[d0:%0] %2(d0) attributes {
+      instances = [{
+        sequence = 2,
+        loop_nest = [{name = "loopB", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: f32):
+        func.call @use(%arg2) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.exit
+  }
+  func.return
+}
@@ -0,0 +1,109 @@
+// RUN: sair-opt %s -sair-eliminate-dead-code | FileCheck %s
+
+func.func private @side_effect(f32)
+
+// CHECK-LABEL: @dead_results
+func.func @dead_results(%arg0: f32, %arg1: f32) {
+  %0 = sair.program {
+    // CHECK: %[[V0:.*]] = sair.from_scalar %{{.*}} : !sair.value<(), f32>
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK-NOT: sair.from_scalar
+    %1 = sair.from_scalar %arg1 : !sair.value<(), f32>
+    // CHECK: %[[R:.*]] = sair.static_range
+    %2 = sair.static_range : !sair.static_range<8>
+    // CHECK: %[[V1:.*]] = sair.map[d0:%[[R]]] %[[V0]] {
+    // CHECK: ^{{.*}}(%{{.*}}: index, %[[ARG0:.*]]: f32):
+    // CHECK-NOT: arith.mulf
+    // CHECK:   %[[ADD:.*]] = arith.addf %[[ARG0]], %[[ARG0]] : f32
+    // CHECK:   sair.return %[[ADD]] : f32
+    // CHECK: } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    %3:2 = sair.map[d0:%2] %0, %1 {
+      ^bb0(%arg2: index, %arg3: f32, %arg4: f32):
+        %4 = arith.addf %arg3, %arg3 : f32
+        %5 = arith.mulf %arg4, %arg4 : f32
+        sair.return %4, %5 : f32, f32
+    } : #sair.shape<d0:static_range<8>>, (f32, f32) -> (f32, f32)
+    // CHECK: %[[V2:.*]] = sair.proj_last of[d0:%[[R]]] %[[V1]](d0)
+    %6 = sair.proj_last of[d0:%2] %3#0(d0) : #sair.shape<d0:static_range<8>>, f32
+    // CHECK: sair.exit %[[V2]] : f32
+    sair.exit %6 : f32
+  } : f32
+  func.return
+}
+
+// CHECK-LABEL: @dead_cycle
+func.func @dead_cycle(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK-NOT: sair.static_range
+    %1 = sair.static_range : !sair.static_range<8>
+    // CHECK-NOT: sair.fby
+    %2 = sair.fby %0 then[d0:%1] %3(d0) : !sair.value<d0:static_range<8>, f32>
+    // CHECK-NOT: sair.map
+    %3 = sair.map[d0:%1] %2(d0) {
+      ^bb0(%arg1: index, %arg2: f32):
+        %4 = arith.addf %arg2, %arg2 : f32
+        sair.return %4 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    // CHECK: sair.exit
+    sair.exit
+  }
+  func.return
+}
+
+// CHECK-LABEL: @side_effects
+func.func @side_effects(%arg0: f32) {
+  sair.program {
+    // CHECK: sair.from_scalar
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: sair.static_range
+    %1 = sair.static_range : !sair.static_range<8>
+    // CHECK: sair.map
+    // CHECK:   call @side_effect
+    sair.map[d0:%1] %0 {
+      ^bb0(%arg1: index, %arg2: f32):
+        func.call @side_effect(%arg2) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.exit
+  }
+  func.return
+}
+
+// Reductions with side effects are kept even if their results are unused.
+// CHECK-LABEL: @map_reduce_side_effects
+func.func @map_reduce_side_effects(%arg0: f32) {
+  sair.program {
+    // CHECK: sair.from_scalar
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // CHECK: sair.static_range
+    %1 = sair.static_range : !sair.static_range<8>
+    // CHECK: sair.map_reduce
+    // CHECK:   call @side_effect
+    %2 = sair.map_reduce %0 reduce[d0:%1] %0 {
+      ^bb0(%arg1: index, %arg2: f32, %arg3: f32):
+        func.call @side_effect(%arg3) : (f32) -> ()
+        %3 = arith.addf %arg2, %arg3 : f32
+        sair.return %3 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    sair.exit
+  }
+  func.return
+}
+
+// CHECK-LABEL: @dead_map_reduce
+func.func @dead_map_reduce(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    %1 = sair.static_range : !sair.static_range<8>
+    // CHECK-NOT: sair.map_reduce
+    %2 = sair.map_reduce %0 reduce[d0:%1] %0 {
+      ^bb0(%arg1: index, %arg2: f32, %arg3: f32):
+        %3 = arith.addf %arg2, %arg3 : f32
+        sair.return %3 : f32
+    } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+    // CHECK: sair.exit
+    sair.exit
+  }
+  func.return
+}
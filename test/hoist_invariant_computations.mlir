@@ -0,0 +1,167 @@
+// RUN: sair-opt %s -sair-hoist-invariant-computations | FileCheck %s
+
+func.func private @foo(f32)
+
+// CHECK-LABEL: @hoist
+func.func @hoist(%arg0: f32) {
+  sair.program {
+    // CHECK: %[[X:.*]] = sair.from_scalar
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), f32>
+    // CHECK: %[[R:.*]] = sair.static_range
+    %1 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+
+    // CHECK: %[[V0:.*]] = sair.map %[[X]] attributes {
+    // CHECK-SAME: loop_nest = []
+    // CHECK-SAME: storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    // CHECK: ^{{.*}}(%[[ARG0:.*]]: f32):
+    // CHECK:   %[[SQR:.*]] = arith.mulf %[[ARG0]], %[[ARG0]] : f32
+    // CHECK:   sair.return %[[SQR]] : f32
+    // CHECK: } : #sair.shape<()>, (f32) -> f32
+
+    // CHECK: %[[V1:.*]] = sair.map[d0:%[[R]]] %[[V0]] attributes {
+    // CHECK-SAME: loop_nest = [{iter = #sair.mapping_expr<d0>, name = "A"}]
+    // CHECK-SAME: storage = [{layout = #sair.named_mapping<[] -> ()>, space = "register"}]
+    // CHECK: ^{{.*}}(%[[D0:.*]]: index, %[[ARG1:.*]]: f32):
+    // CHECK:   %[[I0:.*]] = arith.index_cast %[[D0]] : index to i64
+    // CHECK:   %[[F0:.*]] = arith.sitofp %[[I0]] : i64 to f32
+    // CHECK:   %[[M0:.*]] = arith.mulf %[[F0]], %[[ARG1]] : f32
+    // CHECK:   sair.return %[[M0]] : f32
+    // CHECK: } : #sair.shape<d0:static_range<8>>, (f32) -> f32
+
+    // CHECK: sair.map[d0:%[[R]], d1:%[[R]]] %[[V1]](d0) attributes {
+    // CHECK: ^{{.*}}(%{{.*}}: index, %[[D1:.*]]: index, %[[ARG2:.*]]: f32):
+    // CHECK-NOT: arith.mulf
+    // CHECK:   %[[I1:.*]] = arith.index_cast %[[D1]] : index to i64
+    // CHECK:   %[[F1:.*]] = arith.sitofp %[[I1]] : i64 to f32
+    // CHECK:   %[[A1:.*]] = arith.addf %[[ARG2]], %[[F1]] : f32
+    // CHECK:   call @foo(%[[A1]]) : (f32) -> ()
+    // CHECK: } : #sair.shape<d0:static_range<8> x d1:static_range<8>>, (f32) -> ()
+    sair.map[d0:%1, d1:%1] %0 attributes {
+      instances = [{
+        expansion = "map",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ],
+        sequence = 0,
+        storage = []
+      }]
+    } {
+      ^bb0(%d0: index, %d1: index, %x: f32):
+        %sqr = arith.mulf %x, %x : f32
+        %i0 = arith.index_cast %d0 : index to i64
+        %f0 = arith.sitofp %i0 : i64 to f32
+        %m0 = arith.mulf %f0, %sqr : f32
+        %i1 = arith.index_cast %d1 : index to i64
+        %f1 = arith.sitofp %i1 : i64 to f32
+        %a1 = arith.addf %m0, %f1 : f32
+        func.call @foo(%a1) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8>>, (f32) -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Loops that do not iterate on a prefix of the domain prevent hoisting.
+// CHECK-LABEL: @interchanged
+func.func @interchanged(%arg0: f32) {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    // CHECK: sair.map
+    // CHECK-NOT: sair.map
+    sair.map[d0:%0, d1:%0] attributes {
+      instances = [{
+        expansion = "map",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d1>},
+          {name = "B", iter = #sair.mapping_expr<d0>}
+        ],
+        sequence = 0,
+        storage = []
+      }]
+    } {
+      ^bb0(%d0: index, %d1: index):
+        %i0 = arith.index_cast %d0 : index to i64
+        %f0 = arith.sitofp %i0 : i64 to f32
+        func.call @foo(%f0) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8>>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Values produced by sair.fby must only be used by the operation carrying them,
+// so computations reading them are not hoisted.
+// CHECK-LABEL: @fby
+func.func @fby(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), f32>
+    %1 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    %2 = sair.fby[d0:%1] %0 then[d1:%1] %4(d0, d1) { instances = [{}] }
+      : !sair.value<d0:static_range<8> x d1:static_range<8>, f32>
+    // CHECK: sair.map[d0:%{{.*}}, d1:%{{.*}}, d2:%{{.*}}] %{{.*}}(d0, d1)
+    // CHECK:   arith.mulf
+    // CHECK-NOT: sair.map
+    // CHECK: sair.proj_last
+    %3 = sair.map[d0:%1, d1:%1, d2:%1] %2(d0, d1) attributes {
+      instances = [{
+        expansion = "map",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>},
+          {name = "C", iter = #sair.mapping_expr<d2>}
+        ],
+        sequence = 0,
+        storage = [{space = "register", layout = #sair.named_mapping<[] -> ()>}]
+      }]
+    } {
+      ^bb0(%d0: index, %d1: index, %d2: index, %acc: f32):
+        %sqr = arith.mulf %acc, %acc : f32
+        sair.return %sqr : f32
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8> x d2:static_range<8>>,
+        (f32) -> f32
+    %4 = sair.proj_last[d0:%1, d1:%1] of[d2:%1] %3(d0, d1, d2) {
+      instances = [{}]
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8> x d2:static_range<8>>,
+        f32
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Operations that cannot be speculated, such as divisions by a value that may
+// be zero, are not hoisted out of inner loops that may run zero times.
+// CHECK-LABEL: @division
+func.func @division(%arg0: i32, %arg1: index) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), i32>
+    %1 = sair.from_scalar %arg1 { instances = [{}] } : !sair.value<(), index>
+    %2 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    %3 = sair.dyn_range %1 { instances = [{}] } : !sair.dyn_range
+    // CHECK-NOT: arith.divsi
+    // CHECK: sair.map[d0:%{{.*}}, d1:%{{.*}}]
+    // CHECK:   arith.divsi
+    sair.map[d0:%2, d1:%3] %0 attributes {
+      instances = [{
+        expansion = "map",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ],
+        sequence = 0,
+        storage = []
+      }]
+    } {
+      ^bb0(%d0: index, %d1: index, %x: i32):
+        %i0 = arith.index_cast %d0 : index to i32
+        %q = arith.divsi %x, %i0 : i32
+        %f = arith.sitofp %q : i32 to f32
+        func.call @foo(%f) : (f32) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8> x d1:dyn_range>, (i32) -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
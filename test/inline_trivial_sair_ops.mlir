@@ -46,6 +46,41 @@ func.func @sequence() -> f32 {
   func.return %6 : f32
 }
 
+// CHECK-LABEL: @chain
+func.func @chain() -> f32 {
+  // CHECK: %[[v0:.*]] = arith.constant 1.0
+  %0 = arith.constant 1.0 : f32
+  // CHECK-NOT: sair.program
+  %1 = sair.program {
+    // CHECK-NOT: from_scalar
+    %2 = sair.from_scalar %0 : !sair.value<(), f32>
+    // The users of a trivial map become trivial once it is inlined, even if
+    // they appear before it in the program.
+    // CHECK-NOT: sair.map
+    %5 = sair.map %4 {
+    ^bb0(%arg0: f32):
+      %6 = arith.mulf %arg0, %arg0 : f32
+      sair.return %6 : f32
+    } : #sair.shape<()>, (f32) -> f32
+    %3 = sair.map %2 {
+    ^bb0(%arg0: f32):
+      %7 = arith.addf %arg0, %arg0 : f32
+      sair.return %7 : f32
+    } : #sair.shape<()>, (f32) -> f32
+    %4 = sair.map %3 {
+    ^bb0(%arg0: f32):
+      %8 = arith.subf %arg0, %arg0 : f32
+      sair.return %8 : f32
+    } : #sair.shape<()>, (f32) -> f32
+    // CHECK: %[[v1:.*]] = arith.addf %[[v0]], %[[v0]]
+    // CHECK: %[[v2:.*]] = arith.subf %[[v1]], %[[v1]]
+    // CHECK: %[[v3:.*]] = arith.mulf %[[v2]], %[[v2]]
+    sair.exit %5 : f32
+  } : f32
+  // CHECK: return %[[v3]] : f32
+  func.return %1 : f32
+}
+
 // CHECK-LABEL: @do_nothing
 func.func @do_nothing() {
   %0 = arith.constant 1.0 : f32
@@ -352,6 +352,34 @@ func.func @dyn_range_unroll(%sz: index) {
   func.return
 }
 
+// CHECK-LABEL: @unroll_and_jam
+func.func @unroll_and_jam() {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<4>
+    %1 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    // CHECK: scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+    // CHECK:   scf.for %[[J:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+    // CHECK:     call @foo(%[[I]], %[[J]])
+    // CHECK:     call @foo(%{{.*}}, %[[J]])
+    // CHECK:   }
+    // CHECK-NEXT: }
+    sair.map[d0:%0, d1:%1] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>, unroll_and_jam = 2},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } {
+    ^bb0(%arg0: index, %arg1: index):
+      func.call @foo(%arg0, %arg1) : (index, index) -> ()
+      sair.return
+    } : #sair.shape<d0:static_range<4> x d1:static_range<8>>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
 // CHECK-LABEL: @nested_unroll
 func.func @nested_unroll() {
   sair.program {
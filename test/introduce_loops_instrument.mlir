@@ -0,0 +1,44 @@
+// RUN: sair-opt %s -sair-introduce-loops='instrument=true' | FileCheck %s
+
+func.func private @sair_profile_loop(i64, i64, i64)
+
+// CHECK-LABEL: @map
+// CHECK-SAME: attributes {sair.profile_loops = ["B", "A"]}
+func.func @map(%arg0: index) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), index>
+    %1 = sair.dyn_range %0 { instances = [{}] } : !sair.dyn_range
+    %2 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    sair.map[d0: %1, d1: %2] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d1>},
+          {name = "B", iter = #sair.mapping_expr<d0>}
+        ]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: index):
+        // CHECK: %[[START_A:.*]] = llvm.call_intrinsic "llvm.readcyclecounter"() : () -> i64
+        // CHECK: scf.for
+        // CHECK:   %[[START_B:.*]] = llvm.call_intrinsic "llvm.readcyclecounter"() : () -> i64
+        // CHECK:   scf.for
+        // CHECK:   }
+        // CHECK:   %[[END_B:.*]] = llvm.call_intrinsic "llvm.readcyclecounter"() : () -> i64
+        // CHECK:   %[[CYCLES_B:.*]] = arith.subi %[[END_B]], %[[START_B]] : i64
+        // CHECK:   %[[DIV_B:.*]] = arith.ceildivsi
+        // CHECK:   %[[ZERO:.*]] = arith.constant 0 : index
+        // CHECK:   %[[TRIPS_B:.*]] = arith.maxsi %[[DIV_B]], %[[ZERO]] : index
+        // CHECK:   %[[ID_B:.*]] = arith.constant 0 : i64
+        // CHECK:   %[[TRIPS_B_I64:.*]] = arith.index_cast %[[TRIPS_B]] : index to i64
+        // CHECK:   call @sair_profile_loop(%[[ID_B]], %[[CYCLES_B]], %[[TRIPS_B_I64]])
+        // CHECK: }
+        // CHECK: %[[END_A:.*]] = llvm.call_intrinsic "llvm.readcyclecounter"() : () -> i64
+        // CHECK: %[[CYCLES_A:.*]] = arith.subi %[[END_A]], %[[START_A]] : i64
+        // CHECK: %[[ID_A:.*]] = arith.constant 1 : i64
+        // CHECK: call @sair_profile_loop(%[[ID_A]], %[[CYCLES_A]], %{{.*}})
+        sair.return
+    } : #sair.shape<d0:dyn_range x d1:static_range<8>>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
@@ -0,0 +1,178 @@
+// RUN: sair-opt %s -sair-introduce-loops='specialize-upper-bounds=8,16' | FileCheck %s
+
+// CHECK-LABEL: @dyn_range
+func.func @dyn_range(%arg0: index) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), index>
+    %1 = sair.dyn_range %0 { instances = [{}] } : !sair.dyn_range
+    sair.map[d0: %1] attributes {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>, unroll = 2}]
+      }]
+    } {
+      ^bb0(%arg1: index):
+        // CHECK: %[[C8:.*]] = arith.constant 8 : index
+        // CHECK: %[[IS_8:.*]] = arith.cmpi eq, %[[UB:.*]], %[[C8]] : index
+        // CHECK: scf.if %[[IS_8]] {
+        // CHECK:   scf.for %{{.*}} = %{{.*}} to %[[C8]] step
+        // CHECK:     call @foo
+        // CHECK:     call @foo
+        // CHECK: } else {
+        // CHECK:   %[[C16:.*]] = arith.constant 16 : index
+        // CHECK:   %[[IS_16:.*]] = arith.cmpi eq, %[[UB]], %[[C16]] : index
+        // CHECK:   scf.if %[[IS_16]] {
+        // CHECK:     scf.for %{{.*}} = %{{.*}} to %[[C16]] step
+        // CHECK:   } else {
+        // CHECK:     scf.for %{{.*}} = %{{.*}} to %[[UB]] step
+        // CHECK:   }
+        // CHECK: }
+        func.call @foo(%arg1) : (index) -> ()
+        sair.return
+    } : #sair.shape<d0:dyn_range>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// CHECK-LABEL: @static_range
+func.func @static_range() {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    sair.map[d0: %0] attributes {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}]
+      }]
+    } {
+      ^bb0(%arg1: index):
+        // CHECK-NOT: scf.if
+        // CHECK: scf.for
+        func.call @foo(%arg1) : (index) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<8>>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Only the innermost loop is versioned.
+// CHECK-LABEL: @nested_dyn_ranges
+func.func @nested_dyn_ranges(%arg0: index, %arg1: index) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), index>
+    %1 = sair.from_scalar %arg1 { instances = [{}] } : !sair.value<(), index>
+    %2 = sair.dyn_range %0 { instances = [{}] } : !sair.dyn_range
+    %3 = sair.dyn_range %1 { instances = [{}] } : !sair.dyn_range
+    sair.map[d0: %2, d1: %3] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } {
+      ^bb0(%arg2: index, %arg3: index):
+        // CHECK-NOT: scf.if
+        // CHECK: scf.for
+        // CHECK-NOT: scf.for
+        // CHECK: scf.if
+        // CHECK-COUNT-3: scf.for
+        // CHECK-NOT: scf.for
+        // CHECK: sair.exit
+        func.call @bar(%arg2, %arg3) : (index, index) -> ()
+        sair.return
+    } : #sair.shape<d0:dyn_range x d1:dyn_range>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Loops with a dynamic lower bound, such as normalized strips, are not
+// versioned.
+// CHECK-LABEL: @dynamic_lower_bound
+func.func @dynamic_lower_bound() {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<64, 8>
+    %1, %2 = sair.map[d0:%0] attributes {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}],
+        storage = [
+          {space = "register", layout = #sair.named_mapping<[] -> ()>},
+          {space = "register", layout = #sair.named_mapping<[] -> ()>}
+        ]
+      }]
+    } {
+      ^bb0(%arg0: index):
+        %c8 = arith.constant 8 : index
+        %3 = arith.addi %arg0, %c8 : index
+        sair.return %arg0, %3 : index, index
+    } : #sair.shape<d0:static_range<64, 8>>, () -> (index, index)
+    %3 = sair.dyn_range[d0:%0] %1(d0), %2(d0) { instances = [{}] }
+      : !sair.dyn_range<d0:static_range<64, 8>>
+    // CHECK-NOT: scf.if
+    // CHECK: sair.exit
+    sair.map[d0:%0, d1:%3] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } {
+      ^bb0(%arg0: index, %arg1: index):
+        func.call @bar(%arg0, %arg1) : (index, index) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<64, 8> x d1:dyn_range(d0)>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Unroll-and-jam only applies to versions with a constant trip count.
+// CHECK-LABEL: @unroll_and_jam
+func.func @unroll_and_jam(%arg0: index) {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<4>
+    %1 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), index>
+    %2 = sair.map[d0:%0] %1 attributes {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}],
+        storage = [{space = "register", layout = #sair.named_mapping<[] -> ()>}]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: index):
+        sair.return %arg2 : index
+    } : #sair.shape<d0:static_range<4>>, (index) -> index
+    %3 = sair.dyn_range[d0:%0] %2(d0) { instances = [{}] }
+      : !sair.dyn_range<d0:static_range<4>>
+    sair.map[d0:%0, d1:%3] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>, unroll_and_jam = 2}
+        ]
+      }]
+    } {
+      ^bb0(%arg1: index, %arg2: index):
+        // CHECK: scf.if
+        // CHECK:   scf.for %{{.*}} = %{{.*}} to %[[C8:.*]] step
+        // CHECK:     call @bar
+        // CHECK:     call @bar
+        // CHECK: } else {
+        // CHECK:   scf.if
+        // CHECK:     scf.for %{{.*}} = %{{.*}} to %[[C16:.*]] step
+        // CHECK:       call @bar
+        // CHECK:       call @bar
+        // CHECK:   } else {
+        // CHECK:     scf.for
+        // CHECK-NEXT:  call @bar
+        // CHECK-NEXT: }
+        func.call @bar(%arg1, %arg2) : (index, index) -> ()
+        sair.return
+    } : #sair.shape<d0:static_range<4> x d1:dyn_range(d0)>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+func.func private @foo(index)
+func.func private @bar(index, index)
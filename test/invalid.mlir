@@ -2055,6 +2055,39 @@ func.func @fby_value_overwrite(%arg0 : f32) {
 
 // -----
 
+func.func @sequenced_writes_overwrite(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    // expected-note @+1 {{value stored here}}
+    %1 = sair.copy %0 {
+      instances = [{
+        sequence = 0,
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    %2 = sair.copy %1 { instances = [{sequence = 1}] } : !sair.value<(), f32>
+    // expected-error @+1 {{operation overwrites a value stored in buffer "A" before it is used}}
+    %3 = sair.copy %0 {
+      instances = [{
+        sequence = 2,
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    // expected-note @+1 {{value used here}}
+    %4 = sair.copy %1 { instances = [{sequence = 3}] } : !sair.value<(), f32>
+    %5 = sair.copy %0 {
+      instances = [{
+        sequence = 4,
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    sair.exit
+  }
+  func.return
+}
+
+// -----
+
 func.func @sequence_inversion_two_compute() {
   sair.program {
     // expected-error @below {{operation sequencing contradicts use-def chains}}
@@ -2516,6 +2549,61 @@ func.func @mismatching_unroll() {
 
 // -----
 
+func.func @mismatching_unroll_and_jam() {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<4>
+    // expected-note@below {{previous occurrence here}}
+    sair.map[d0:%0] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>, unroll_and_jam = 4}
+        ]
+      }]
+    } {
+    ^bb0(%arg0: index):
+      sair.return
+    } : #sair.shape<d0:static_range<4>>, () -> ()
+
+    // expected-error@below {{mismatching unroll-and-jam factors for loop "A" (2 vs 4)}}
+    sair.map[d0:%0] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>, unroll_and_jam = 2}
+        ]
+      }]
+    } {
+    ^bb0(%arg0: index):
+      sair.return
+    } : #sair.shape<d0:static_range<4>>, () -> ()
+    sair.exit
+  }
+  func.return
+}
+
+// -----
+
+func.func @unroll_and_jam_dynamic_range(%arg0: index) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), index>
+    %1 = sair.dyn_range %0 : !sair.dyn_range
+    // expected-error@below {{loop "A" iterates on a dynamic range and cannot be unrolled and jammed}}
+    sair.map[d0:%1] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>, unroll_and_jam = 2}
+        ]
+      }]
+    } {
+    ^bb0(%arg1: index):
+      sair.return
+    } : #sair.shape<d0:dyn_range>, () -> ()
+    sair.exit
+  }
+  func.return
+}
+
+// -----
+
 func.func @mismatching_unroll_missing() {
   sair.program {
     %0 = sair.static_range : !sair.static_range<3>
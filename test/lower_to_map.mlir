@@ -119,6 +119,61 @@ func.func @load_from_memref(%arg0 : memref<?x?xf32>) {
   func.return
 }
 
+// CHECK-LABEL: @load_prefetch
+func.func @load_prefetch(%arg0 : memref<8x16xf32>) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<8>
+    %1 = sair.static_range : !sair.static_range<16>
+    %2 = sair.from_scalar %arg0 : !sair.value<(), memref<8x16xf32>>
+    // CHECK: sair.map[d0:%{{.*}}, d1:%{{.*}}] %{{.*}}
+    // CHECK: ^{{.*}}(%{{.*}}: index, %{{.*}}: index, %[[MEMREF:.*]]: memref<8x16xf32>):
+    // CHECK:   %[[I0:.*]] = affine.apply
+    // CHECK:   %[[I1:.*]] = affine.apply
+    // CHECK:   %[[VALUE:.*]] = memref.load %[[MEMREF]][%[[I0]], %[[I1]]] : memref<8x16xf32>
+    // CHECK:   %[[DIM:.*]] = memref.dim %[[MEMREF]]
+    // CHECK:   %[[NEXT:.*]] = affine.min affine_map<(d0)[s0] -> (d0 + 16, s0 - 1)>(%[[I1]])[%[[DIM]]]
+    // CHECK:   memref.prefetch %[[MEMREF]][%[[I0]], %[[NEXT]]], read, locality<3>, data : memref<8x16xf32>
+    // CHECK:   sair.return %[[VALUE]] : f32
+    %3 = sair.load_from_memref[d0:%0, d1:%1] %2 {
+      layout = #sair.mapping<2 : d0, d1>,
+      instances = [{
+        expansion = "load_prefetch",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } : memref<8x16xf32> -> !sair.value<d0:static_range<8> x d1:static_range<16>, f32>
+    sair.exit
+  }
+  func.return
+}
+
+// The innermost loop walks the outer operand of an unstripe expression and
+// advances by a full strip on each iteration, so no prefetch is issued.
+// CHECK-LABEL: @load_prefetch_strided
+func.func @load_prefetch_strided(%arg0 : memref<16xf32>) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<4>
+    %1 = sair.from_scalar %arg0 : !sair.value<(), memref<16xf32>>
+    // CHECK: memref.load
+    // CHECK-NOT: memref.prefetch
+    // CHECK: sair.return
+    %2 = sair.load_from_memref[d0:%0, d1:%0] %1 {
+      layout = #sair.mapping<2 : unstripe(d1, d0, [4, 1])>,
+      instances = [{
+        expansion = "load_prefetch",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<d1>}
+        ]
+      }]
+    } : memref<16xf32> -> !sair.value<d0:static_range<4> x d1:static_range<4>, f32>
+    sair.exit
+  }
+  func.return
+}
+
 // CHECK-LABEL: @store_to_memref
 func.func @store_to_memref(%arg0 : f32, %arg1 : memref<?x?xf32>) {
   sair.program {
@@ -147,3 +202,24 @@ func.func @store_to_memref(%arg0 : f32, %arg1 : memref<?x?xf32>) {
   }
   func.return
 }
+
+// CHECK-LABEL: @store_nontemporal
+func.func @store_nontemporal(%arg0 : f32, %arg1 : memref<8xf32>) {
+  sair.program {
+    %0 = sair.static_range : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    %2 = sair.from_scalar %arg1 : !sair.value<(), memref<8xf32>>
+    %3 = sair.copy[d0:%0] %1 {
+      instances = [{expansion = "copy"}]
+    } : !sair.value<d0:static_range<8>, f32>
+
+    // CHECK: sair.map[d0:%{{.*}}] %{{.*}}, %{{.*}}(d0)
+    // CHECK:   memref.store %{{.*}}, %{{.*}}[%{{.*}}] {nontemporal = true}
+    sair.store_to_memref[d0:%0] %2, %3(d0) {
+      layout = #sair.mapping<1 : d0>,
+      instances = [{expansion = "store_nontemporal"}]
+    } : #sair.shape<d0:static_range<8>>, memref<8xf32>
+    sair.exit
+  }
+  func.return
+}
@@ -122,27 +122,15 @@ func.func @loop_nest(%arg0: f32) {
   sair.program {
     // CHECK: %[[D0:.*]] = sair.placeholder {instances = [{operands = []}]} : !sair.static_range<16, 4>
 
-    // CHECK: %[[V0:.*]] = sair.map[d0:%[[D0]]] attributes {
+    // Strips of a static range have a static size.
+    // CHECK-NOT: sair.map
+    // CHECK: %[[V6:.*]] = sair.alloc[d0:%[[D0]]] {
     // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "A"}]
-    // CHECK: } {
-    // CHECK:   ^{{.*}}(%[[ARG0:.*]]: index):
-    // CHECK:     %[[V1:.*]] = affine.apply affine_map<(d0) -> (d0)>(%[[ARG0]])
-    // CHECK:     %[[C4:.*]] = arith.constant 4
-    // CHECK:     %[[V2:.*]] = arith.addi %[[V1]], %[[C4]]
-    // CHECK:     %[[C16:.*]] = arith.constant 16
-    // CHECK:     %[[V3:.*]] = arith.cmpi ult, %[[C16]], %[[V2]]
-    // CHECK:     %[[V4:.*]] = arith.select %[[V3]], %[[C16]], %[[V2]]
-    // CHECK:     %[[V5:.*]] = affine.apply affine_map<(d0, d1) -> (d1 - d0)>
-    // CHECK:     sair.return %[[V5]] : index
-    // CHECK: } : #sair.shape<d0:static_range<16, 4>>, () -> index
-
-    // CHECK: %[[V6:.*]] = sair.alloc[d0:%[[D0]]] %[[V0]](d0) {
-    // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "A"}]
-    // CHECK: }  : !sair.value<d0:static_range<16, 4>, memref<?xf32>>
+    // CHECK: }  : !sair.value<d0:static_range<16, 4>, memref<4xf32>>
 
     // CHECK: sair.free[d0:%[[D0]]] %[[V6]](d0) {
     // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "A"}]
-    // CHECK: } : !sair.value<d0:static_range<16, 4>, memref<?xf32>>
+    // CHECK: } : !sair.value<d0:static_range<16, 4>, memref<4xf32>>
 
     %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), f32>
     %1 = sair.static_range { instances = [{}] } : !sair.static_range<16>
@@ -163,7 +151,7 @@ func.func @loop_nest(%arg0: f32) {
     // CHECK: sair.store_to_memref[d0:%{{.*}}, d1:%{{.*}}] %[[V6]](d0), %[[V7]](unstripe(d0, d1, [4, 1]))
     // CHECK:   loop_nest = [{iter = #sair.mapping_expr<d0>, name = "A"}, {iter = #sair.mapping_expr<d1>, name = "B"}]
     // CHECK:   layout = #sair.mapping<2 : d1>
-    // CHECK:   : #sair.shape<d0:static_range<16, 4> x d1:dyn_range(d0)>, memref<?xf32>
+    // CHECK:   : #sair.shape<d0:static_range<16, 4> x d1:dyn_range(d0)>, memref<4xf32>
 
     // CHECK: %[[V8:.*]] = sair.load_from_memref[d0:%{{.*}}, d1:%{{.*}}] %[[V6]](d0)
     // CHECK:   loop_nest = [
@@ -171,7 +159,7 @@ func.func @loop_nest(%arg0: f32) {
     // CHECK:     {iter = #sair.mapping_expr<d1>, name = "C"},
     // CHECK:     {iter = #sair.mapping_expr<d2>, name = "D"}]
     // CHECK:   layout = #sair.mapping<3 : d1>
-    // CHECK:   : memref<?xf32> -> !sair.value<d0:static_range<16, 4> x d1:dyn_range(d0) x d2:static_range<16>, f32>
+    // CHECK:   : memref<4xf32> -> !sair.value<d0:static_range<16, 4> x d1:dyn_range(d0) x d2:static_range<16>, f32>
     // CHECK: %[[V9:.*]] = sair.proj_any[d0:%{{.*}}] of[d1:%{{.*}}] %[[V8]](stripe(d0, [4]), stripe(d0, [4, 1]), d1)
     // CHECK:   : #sair.shape<d0:static_range<16> x d1:static_range<16>>, f32
     // CHECK: %[[V10:.*]] = sair.copy[d0:%{{.*}}] %[[V9]](d0)
@@ -204,7 +192,7 @@ func.func @loop_nest(%arg0: f32) {
     // CHECK:       {iter = #sair.mapping_expr<d1>, name = "C"},
     // CHECK:       {iter = #sair.mapping_expr<d2>, name = "D"}]
     // CHECK:   layout = #sair.mapping<3 : d1>
-    // CHECK:   : #sair.shape<d0:static_range<16, 4> x d1:dyn_range(d0) x d2:static_range<16>>, memref<?xf32>
+    // CHECK:   : #sair.shape<d0:static_range<16, 4> x d1:dyn_range(d0) x d2:static_range<16>>, memref<4xf32>
     sair.exit { instances = [{}] }
   }
   func.return
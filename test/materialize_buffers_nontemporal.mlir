@@ -0,0 +1,65 @@
+// RUN: sair-opt %s -sair-materialize-buffers=nontemporal-stores=true \
+// RUN:   -mlir-print-local-scope | FileCheck %s
+
+// CHECK-LABEL: @write_only
+func.func @write_only(%arg0: f32, %arg1: memref<16xf32>) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), f32>
+    %1 = sair.from_scalar %arg1 { instances = [{}] }
+      : !sair.value<(), memref<16xf32>>
+    %2 = sair.static_range { instances = [{}] } : !sair.static_range<16>
+    %3 = sair.copy[d0:%2] %0 {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}],
+        storage = [{name = "OUT", space = "memory",
+                    layout = #sair.named_mapping<[d0:"A"] -> (d0)>}]
+      }]
+    } : !sair.value<d0:static_range<16>, f32>
+    // CHECK: sair.store_to_memref
+    // CHECK-SAME: expansion = "store_nontemporal"
+    sair.to_memref %1 memref[d0:%2] %3(d0) {
+      instances = [{}],
+      buffer_name = "OUT"
+    } : #sair.shape<d0:static_range<16>>, memref<16xf32>
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// The memref written to "OUT" is also read through "IN", so stores keep it in
+// cache.
+// CHECK-LABEL: @aliasing_import
+func.func @aliasing_import(%arg0: memref<16xf32>) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] }
+      : !sair.value<(), memref<16xf32>>
+    %1 = sair.static_range { instances = [{}] } : !sair.static_range<16>
+    %2 = sair.from_memref %0 memref[d0:%1] {
+      instances = [{}],
+      buffer_name = "IN"
+    } : #sair.shape<d0:static_range<16>>, memref<16xf32>
+    // CHECK: sair.load_from_memref
+    %3 = sair.copy[d0:%1] %2(d0) {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}],
+        storage = [{space = "register",
+                    layout = #sair.named_mapping<[] -> ()>}]
+      }]
+    } : !sair.value<d0:static_range<16>, f32>
+    %4 = sair.copy[d0:%1] %3(d0) {
+      instances = [{
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}],
+        storage = [{name = "OUT", space = "memory",
+                    layout = #sair.named_mapping<[d0:"A"] -> (d0)>}]
+      }]
+    } : !sair.value<d0:static_range<16>, f32>
+    // CHECK: sair.store_to_memref
+    // CHECK-SAME: expansion = "store",
+    sair.to_memref %0 memref[d0:%1] %4(d0) {
+      instances = [{}],
+      buffer_name = "OUT"
+    } : #sair.shape<d0:static_range<16>>, memref<16xf32>
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
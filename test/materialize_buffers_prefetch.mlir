@@ -0,0 +1,76 @@
+// RUN: sair-opt %s -sair-materialize-buffers=prefetch=true \
+// RUN:   -mlir-print-local-scope | FileCheck %s
+// RUN: sair-opt %s -sair-materialize-buffers=prefetch=true -canonicalize \
+// RUN:   -sair-normalize-loops -sair-lower-to-map -mlir-print-local-scope \
+// RUN:   | FileCheck %s --check-prefix=LOWERED
+
+// CHECK-LABEL: @external
+// LOWERED-LABEL: @external
+func.func @external(%arg0: memref<8x16xf32>) {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<8>
+    %1 = sair.static_range { instances = [{}] } : !sair.static_range<16>
+    %2 = sair.from_scalar %arg0 { instances = [{}] }
+      : !sair.value<(), memref<8x16xf32>>
+    %3 = sair.from_memref %2 memref[d0:%0, d1:%1] {
+      instances = [{}],
+      buffer_name = "A"
+    } : #sair.shape<d0:static_range<8> x d1:static_range<16>>, memref<8x16xf32>
+
+    // CHECK: sair.load_from_memref
+    // CHECK-SAME: expansion = "load_prefetch"
+
+    // The prefetch pattern is kept through loop normalization. The innermost
+    // loop iterates within strips of 4 elements, which caps the distance.
+    // LOWERED: sair.map
+    // LOWERED:   %[[VALUE:.*]] = memref.load
+    // LOWERED:   affine.min affine_map<(d0)[s0] -> (d0 + 4, s0 - 1)>
+    // LOWERED:   memref.prefetch
+    // LOWERED:   sair.return %[[VALUE]] : f32
+    %4 = sair.copy[d0:%0, d1:%1] %3(d0, d1) {
+      instances = [{
+        expansion = "copy",
+        loop_nest = [
+          {name = "A", iter = #sair.mapping_expr<d0>},
+          {name = "B", iter = #sair.mapping_expr<stripe(d1, [4])>},
+          {name = "C", iter = #sair.mapping_expr<stripe(d1, [4, 1])>}
+        ],
+        storage = [{space = "register", layout = #sair.named_mapping<[] -> ()>}]
+      }]
+    } : !sair.value<d0:static_range<8> x d1:static_range<16>, f32>
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
+
+// Loads from buffers allocated by the program are not prefetched.
+// CHECK-LABEL: @internal
+// LOWERED-LABEL: @internal
+func.func @internal(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), f32>
+    %1 = sair.static_range { instances = [{}] } : !sair.static_range<16>
+    %2 = sair.copy[d0:%1] %0 {
+      instances = [{
+        expansion = "copy",
+        loop_nest = [{name = "A", iter = #sair.mapping_expr<d0>}],
+        storage = [{
+          name = "B", space = "memory",
+          layout = #sair.named_mapping<[d0:"A"] -> (d0)>
+        }]
+      }]
+    } : !sair.value<d0:static_range<16>, f32>
+    // CHECK: sair.load_from_memref
+    // CHECK-SAME: expansion = "load",
+    // LOWERED-NOT: memref.prefetch
+    %3 = sair.copy[d0:%1] %2(d0) {
+      instances = [{
+        expansion = "copy",
+        loop_nest = [{name = "C", iter = #sair.mapping_expr<d0>}],
+        storage = [{space = "register", layout = #sair.named_mapping<[] -> ()>}]
+      }]
+    } : !sair.value<d0:static_range<16>, f32>
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
@@ -235,6 +235,8 @@ func.func private @foo(index, f32)
 func.func @sequence_attr(%arg0: f32) {
   sair.program {
     %0 = sair.from_scalar %arg0 { instances = [{}] } : !sair.value<(), f32>
+    // Loops with the same static range reuse existing range operations.
+    // CHECK: %[[OTHER_STATIC:.*]] = sair.static_range {instances = [{}]} : !sair.static_range<16>
     // CHECK: %[[STATIC:.*]] = sair.static_range {instances = [{operands = []}]} : !sair.static_range<16, 4>
     %1 = sair.static_range { instances = [{}] } : !sair.static_range<16>
 
@@ -244,10 +246,8 @@ func.func @sequence_attr(%arg0: f32) {
     // CHECK:   %[[V1:.*]] = affine.apply affine_map<(d0) -> (d0)>(%[[ARG]])
     // CHECK:   %[[C4:.*]] = arith.constant 4
     // CHECK:   %[[V2:.*]] = arith.addi %[[V1]], %[[C4]]
-    // CHECK:   %[[C16:.*]] = arith.constant 16
-    // CHECK:   %[[V3:.*]] = arith.cmpi ult, %[[C16]], %[[V2]]
-    // CHECK:   %[[V4:.*]] = arith.select %[[V3]], %[[C16]], %[[V2]]
-    // CHECK:   sair.return %[[V1]], %[[V4]]
+    // CHECK-NOT: arith.select
+    // CHECK:   sair.return %[[V1]], %[[V2]]
     // CHECK: %[[DYN:.*]] = sair.dyn_range[d0:%[[STATIC]]] %[[RANGE]]#0(d0), %[[RANGE]]#1(d0)
 
     // CHECK: sair.map[d0:%[[STATIC]], d1:%[[DYN]]]
@@ -266,7 +266,7 @@ func.func @sequence_attr(%arg0: f32) {
       sair.return
     } : #sair.shape<d0:static_range<16>>, (f32) -> ()
 
-    // CHECK: %[[OTHER_STATIC:.*]] = sair.static_range {instances = [{operands = []}]} : !sair.static_range<16>
+    // CHECK-NOT: sair.static_range
     // CHECK: sair.map[d0:%[[OTHER_STATIC]]]
     // CHECK-SAME: sequence = 3
     sair.map[d0:%1] %0 attributes {
@@ -360,3 +360,54 @@ func.func @unroll_propagated() {
   } : index
   func.return
 }
+
+// The first two operations have identical occurrences of loops A and B, while
+// the third iterates on them along another dimension. All three operations
+// share the same fusion classes and are normalized to the same ranges.
+// CHECK-LABEL: @shared_occurrences
+func.func @shared_occurrences() {
+  sair.program {
+    %0 = sair.static_range { instances = [{}] } : !sair.static_range<16>
+    // CHECK: %[[D0:.*]] = sair.static_range {{.*}} : !sair.static_range<16, 4>
+    // CHECK: %[[D1:.*]] = sair.dyn_range[d0:%[[D0]]]
+    // CHECK: sair.map[d0:%[[D0]], d1:%[[D1]]] attributes
+    sair.map[d0:%0] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<stripe(d0, [4])>},
+          {name = "loopB", iter = #sair.mapping_expr<stripe(d0, [4, 1])>}
+        ]
+      }]
+    } {
+      ^bb0(%arg0: index):
+        sair.return
+    } : #sair.shape<d0:static_range<16>>, () -> ()
+    // CHECK: sair.map[d0:%[[D0]], d1:%[[D1]]] attributes
+    sair.map[d0:%0] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<stripe(d0, [4])>},
+          {name = "loopB", iter = #sair.mapping_expr<stripe(d0, [4, 1])>}
+        ]
+      }]
+    } {
+      ^bb0(%arg0: index):
+        sair.return
+    } : #sair.shape<d0:static_range<16>>, () -> ()
+    // CHECK: sair.map[d0:%[[D0]], d1:%[[D1]], d2:%{{.*}}] attributes
+    sair.map[d0:%0, d1:%0] attributes {
+      instances = [{
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<stripe(d1, [4])>},
+          {name = "loopB", iter = #sair.mapping_expr<stripe(d1, [4, 1])>},
+          {name = "loopC", iter = #sair.mapping_expr<d0>}
+        ]
+      }]
+    } {
+      ^bb0(%arg0: index, %arg1: index):
+        sair.return
+    } : #sair.shape<d0:static_range<16> x d1:static_range<16>>, () -> ()
+    sair.exit { instances = [{}] }
+  }
+  func.return
+}
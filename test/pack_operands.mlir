@@ -0,0 +1,86 @@
+// RUN: sair-opt %s -sair-pack-operands | FileCheck %s
+// RUN: sair-opt %s -sair-pack-operands -sair-materialize-instances \
+// RUN:   | FileCheck --check-prefix=MATERIALIZED %s
+
+// CHECK-LABEL: @pack_tile
+func.func @pack_tile(%arg0: memref<8x8xf32>) {
+  sair.program {
+    %0 = sair.static_range { instances = [{operands = []}] }
+      : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 {
+      instances = [{operands = [#sair.instance<0>]}]
+    } : !sair.value<(), memref<8x8xf32>>
+    // The copy is nested in "loopA" and stores a 4x8 tile of the operand,
+    // indexed by the two loops it adds.
+    // CHECK: %[[V0:.*]] = sair.from_memref
+    // CHECK: copies = {{\[\[}}{
+    // CHECK:   copy_of = #sair.instance<0>
+    // CHECK:   expansion = "copy"
+    // CHECK:   loop_nest = [
+    // CHECK-SAME: {iter = #sair.mapping_expr<stripe(d0, [4])>, name = "loopA"},
+    // CHECK-SAME: {iter = #sair.mapping_expr<stripe(d0, [4, 1])>,
+    // CHECK-SAME:  name = "[[L0:[^"]*]]"},
+    // CHECK-SAME: {iter = #sair.mapping_expr<d1>, name = "[[L1:[^"]*]]"}]
+    // CHECK:   sequence = 1
+    // CHECK:   storage = [{
+    // CHECK-SAME: layout = #sair.named_mapping<[d0:"[[L0]]", d1:"[[L1]]"]
+    // CHECK-SAME:   -> (d0, d1)>
+    // CHECK-SAME: space = "memory"
+    // MATERIALIZED: %[[MEMREF:.*]] = sair.from_memref
+    // MATERIALIZED: %[[COPY:.*]] = sair.copy[d0:%{{.*}}, d1:%{{.*}}] %[[MEMREF]](d0, d1)
+    %2 = sair.from_memref %1 memref[d0:%0, d1:%0] {
+      buffer_name = "A",
+      instances = [{operands = [#sair.instance<0>, #sair.instance<0>,
+                                #sair.instance<0>]}]
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8>>, memref<8x8xf32>
+
+    // CHECK: sair.map[d0:%{{.*}}, d1:%{{.*}}, d2:%{{.*}}] %[[V0]](d0, d2)
+    // CHECK:   operands = [#sair.instance<0>, #sair.instance<0>,
+    // CHECK-SAME: #sair.instance<0>, #sair.copy<0>]
+    // MATERIALIZED: sair.map[d0:%{{.*}}, d1:%{{.*}}, d2:%{{.*}}] %[[COPY]](d0, d2)
+    sair.map[d0:%0, d1:%0, d2:%0] %2(d0, d2) attributes {
+      instances = [{
+        sequence = 1,
+        loop_nest = [
+          {name = "loopA", iter = #sair.mapping_expr<stripe(d0, [4])>},
+          {name = "loopB", iter = #sair.mapping_expr<d1>},
+          {name = "loopC", iter = #sair.mapping_expr<stripe(d0, [4, 1])>},
+          {name = "loopD", iter = #sair.mapping_expr<d2>}
+        ]
+      }]
+    } {
+    ^bb0(%i: index, %j: index, %k: index, %a: f32):
+      sair.return
+    } : #sair.shape<d0:static_range<8> x d1:static_range<8> x d2:static_range<8>>, (f32) -> ()
+    sair.exit { instances = [{operands = []}] }
+  }
+  func.return
+}
+
+// CHECK-LABEL: @no_reuse
+func.func @no_reuse(%arg0: memref<8xf32>) {
+  sair.program {
+    %0 = sair.static_range { instances = [{operands = []}] }
+      : !sair.static_range<8>
+    %1 = sair.from_scalar %arg0 {
+      instances = [{operands = [#sair.instance<0>]}]
+    } : !sair.value<(), memref<8xf32>>
+    // CHECK: sair.from_memref
+    // CHECK-NOT: copies
+    %2 = sair.from_memref %1 memref[d0:%0] {
+      buffer_name = "A",
+      instances = [{operands = [#sair.instance<0>, #sair.instance<0>]}]
+    } : #sair.shape<d0:static_range<8>>, memref<8xf32>
+    sair.map[d0:%0] %2(d0) attributes {
+      instances = [{
+        loop_nest = [{name = "loopA", iter = #sair.mapping_expr<d0>}],
+        operands = [#sair.instance<0>, #sair.instance<0>]
+      }]
+    } {
+    ^bb0(%i: index, %a: f32):
+      sair.return
+    } : #sair.shape<d0:static_range<8>>, (f32) -> ()
+    sair.exit { instances = [{operands = []}] }
+  }
+  func.return
+}
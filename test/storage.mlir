@@ -31,3 +31,63 @@ func.func @from_memref_in_memory(%arg0: memref<?xf32>, %arg1: f32) {
   func.return
 }
 
+
+// Writes to a buffer sequenced right before and right after a value is stored
+// and used do not overwrite it.
+// CHECK-LABEL: @sequenced_writes
+func.func @sequenced_writes(%arg0: f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    %1 = sair.copy %0 {
+      instances = [{
+        sequence = 0,
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    %2 = sair.copy %1 { instances = [{sequence = 1}] } : !sair.value<(), f32>
+    %3 = sair.copy %0 {
+      instances = [{
+        sequence = 2,
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    %4 = sair.copy %3 { instances = [{sequence = 3}] } : !sair.value<(), f32>
+    %5 = sair.copy %0 {
+      instances = [{
+        sequence = 4,
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    %6 = sair.copy %5 { instances = [{sequence = 5}] } : !sair.value<(), f32>
+    sair.exit
+  }
+  func.return
+}
+
+// The value carried by sair.fby is stored by the last operation of loop B, so
+// it is live from after that operation to the end of the loop. Writes after
+// the loop do not overwrite it.
+// CHECK-LABEL: @fby_value_written_after_loop
+func.func @fby_value_written_after_loop(%arg0 : f32) {
+  sair.program {
+    %0 = sair.from_scalar %arg0 : !sair.value<(), f32>
+    %r = sair.static_range : !sair.static_range<8>
+    %1 = sair.copy %0 {
+      instances = [{storage = [{name = "A", space = "memory"}]}]
+    } : !sair.value<(), f32>
+    %2 = sair.fby %1 then[d0:%r] %3(d0) : !sair.value<d0:static_range<8>, f32>
+    %3 = sair.copy[d0:%r] %2(d0) {
+      instances = [{
+        loop_nest = [{name = "B", iter = #sair.mapping_expr<d0>}]
+      }]
+    } : !sair.value<d0:static_range<8>, f32>
+    %4 = sair.copy %0 {
+      instances = [{
+        loop_nest = [],
+        storage = [{name = "A", space = "memory"}]
+      }]
+    } : !sair.value<(), f32>
+    sair.exit
+  }
+  func.return
+}
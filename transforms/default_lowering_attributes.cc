@@ -16,17 +16,23 @@
 
 #include <iterator>
 #include <memory>
+#include <optional>
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/MLIRContext.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
+#include "expansion.h"
+#include "loop_nest.h"
 #include "sair_attributes.h"
 #include "sair_dialect.h"
 #include "sair_op_interfaces.h"
@@ -47,6 +53,7 @@ namespace {
 #define GEN_PASS_DEF_DEFAULTLOOPNESTPASS
 #define GEN_PASS_DEF_DEFAULTSEQUENCEPASS
 #define GEN_PASS_DEF_DEFAULTSTORAGEPASS
+#define GEN_PASS_DEF_PACKOPERANDSPASS
 #include "transforms/default_lowering_attributes.h.inc"
 
 // Creates a blank instance for ComputeOp with no instances.
@@ -69,6 +76,8 @@ mlir::LogicalResult CommitStorage(
   mlir::MLIRContext *context = op.context();
   const IterationSpace &iter_space = iteration_spaces.Get(op);
 
+  // Set the storage of all results at once to rebuild decisions only once.
+  llvm::SmallVector<BufferAttr> storages;
   for (int i = 0, e = op.num_results(); i < e; ++i) {
     const ValueStorage &storage = storage_analysis.GetStorage(op.Result(i));
 
@@ -87,10 +96,10 @@ mlir::LogicalResult CommitStorage(
       layout = NamedMappingAttr::get(loop_names, renaming, context)
                    .Compose(storage.layout());
     }
-    auto attr = BufferAttr::get(storage.space(), storage.buffer_name(), layout,
-                                context);
-    op.SetStorage(i, attr);
+    storages.push_back(BufferAttr::get(storage.space(), storage.buffer_name(),
+                                       layout, context));
   }
+  if (!storages.empty()) op.SetStorage(storages);
   return mlir::success();
 }
 
@@ -108,13 +117,12 @@ bool FitsInRegisters(const OperandInstance &operand,
   return mapping.MinDomainSize() <= common_loops;
 }
 
-// Initialize storage for value with default values if needed. Memory space is
-// initialized with `register` and layout is initialized with `?`
-// expressions.
-void InitializeStorage(ResultInstance value,
-                       const LoopFusionAnalysis &fusion_analysis,
-                       const IterationSpaceAnalysis &iteration_spaces,
-                       StorageAnalysis &storage_analysis) {
+// Returns the storage of value initialized with default values if needed.
+// Memory space is initialized with `register` and layout is initialized with
+// `?` expressions.
+ValueStorage GetInitialStorage(ResultInstance value,
+                               const IterationSpaceAnalysis &iteration_spaces,
+                               const StorageAnalysis &storage_analysis) {
   OpInstance defining_op = value.defining_op();
   mlir::MLIRContext *context = defining_op.context();
   SairDialect *sair_dialect = defining_op.GetSairDialect();
@@ -139,8 +147,7 @@ void InitializeStorage(ResultInstance value,
     auto layout = MappingAttr::get(context, iter_space.mapping().size(), exprs);
     AssertSuccess(storage.MergeLayout(layout));
   }
-  storage_analysis.MergeStorage(value, storage, fusion_analysis,
-                                iteration_spaces);
+  return storage;
 }
 
 // Adds new dimensions to the operand value layout so that the operand has
@@ -212,15 +219,13 @@ mlir::LogicalResult ExtendLayout(const OperandInstance &operand,
   return mlir::success();
 }
 
-// Converts unknown expressions from value layout to `none` expressions.
-void MakeLayoutFullySpecified(const ResultInstance &value,
-                              const LoopFusionAnalysis &fusion_analysis,
-                              const IterationSpaceAnalysis &iteration_spaces,
-                              StorageAnalysis &storage_analysis) {
+// Returns the storage of value with unknown layout expressions converted to
+// `none` expressions.
+ValueStorage GetFullySpecifiedStorage(const ResultInstance &value,
+                                      const StorageAnalysis &storage_analysis) {
   ValueStorage storage = storage_analysis.GetStorage(value);
   AssertSuccess(storage.MergeLayout(storage.layout().MakeFullySpecified()));
-  storage_analysis.MergeStorage(value, storage, fusion_analysis,
-                                iteration_spaces);
+  return storage;
 }
 
 // Assings a buffer name to the operand if it cannot fit in registers.
@@ -246,6 +251,217 @@ static mlir::LogicalResult CreateBufferIfNeeded(
   return mlir::success();
 }
 
+// Sets the instance or copy of its value a compute operation operand reads
+// from.
+void SetOperandSource(ComputeOpInstance user, int operand_position,
+                      mlir::Attribute source) {
+  mlir::MLIRContext *context = user.context();
+  SairOp sair_op = user.GetSairOp();
+  DecisionsAttr decisions = user.GetDecisions();
+
+  llvm::SmallVector<mlir::Attribute> operands;
+  if (decisions.operands() == nullptr) {
+    llvm::append_range(operands, GetInstanceZeroOperands(
+                                     context, sair_op->getNumOperands()));
+  } else {
+    llvm::append_range(operands, decisions.operands().getValue());
+  }
+  operands[sair_op.getDomain().size() + operand_position] = source;
+  user.SetDecisions(UpdateOperands(decisions, operands));
+}
+
+// An operand whose producer is recomputed in the loop nest of the user instead
+// of being stored in memory.
+struct RematerializationCandidate {
+  ComputeOpInstance user;
+  int operand_position;
+  // Loop nest of the new producer instance.
+  mlir::ArrayAttr loop_nest;
+};
+
+// Counts the operations executed by one iteration of a sair.map body.
+int NumBodyOps(SairMapOp op) {
+  int num_ops = 0;
+  for (mlir::Operation &body_op : op.block().without_terminator()) {
+    body_op.walk([&](mlir::Operation *) { ++num_ops; });
+  }
+  return num_ops;
+}
+
+// Computes the loop nest of an instance of the operand producer that is nested
+// in the loops of the user and computes, at each iteration, the exact element
+// the user reads. Loops of the user that do not index the operand rematerialize
+// the producer. Returns nullptr if no such loop nest exists.
+mlir::ArrayAttr GetRematerializedLoopNest(
+    const ComputeOpInstance &user, int operand_position,
+    const IterationSpace &use_iter_space) {
+  mlir::MLIRContext *context = user.context();
+  OperandInstance operand(user, operand_position);
+  ResultInstance value = *operand.GetValue();
+  int rank = value.GetType().cast<ValueType>().Shape().NumDimensions();
+
+  // Loops of the user must iterate over the same ranges as the producer.
+  SairOp producer = value.defining_op().GetSairOp();
+  SairOp user_op = user.GetSairOp();
+  for (auto [dimension, expr] :
+       llvm::enumerate(operand.Mapping().Dimensions())) {
+    auto dim_expr = expr.dyn_cast<MappingDimExpr>();
+    if (dim_expr == nullptr || producer.getDomain()[dimension] !=
+                                   user_op.getDomain()[dim_expr.dimension()]) {
+      return nullptr;
+    }
+  }
+
+  // Express the loops of the user in the domain of the producer.
+  MappingAttr iters =
+      operand.Mapping().Inverse().Compose(use_iter_space.MappingToLoops());
+  if (iters.HasUnknownExprs() || iters.Inverse().HasNoneExprs()) {
+    return nullptr;
+  }
+
+  llvm::SmallVector<mlir::Attribute> loop_nest;
+  for (auto [attr, iter] : llvm::zip(user.Loops(), iters.Dimensions())) {
+    auto loop = attr.cast<LoopAttr>();
+    loop_nest.push_back(LoopAttr::get(loop.name(), iter, loop.unroll(),
+                                      loop.unroll_and_jam(), context));
+  }
+
+  // Ensure the element is consumed in the iteration that produces it.
+  IterationSpace remat_iter_space(use_iter_space.loop_names(), iters,
+                                  /*fully_specified=*/true);
+  if (!CommunicationVolume(rank, remat_iter_space, use_iter_space).empty()) {
+    return nullptr;
+  }
+  return mlir::ArrayAttr::get(context, loop_nest);
+}
+
+// Finds operands that would need a buffer but whose producer is a sair.map
+// operation cheap enough to be recomputed in the loops of the user. The cost of
+// recomputing is the number of operations of the producer body, and the cost
+// of storing is the number of dimensions of the communication volume between
+// the producer and the user. An operand is rematerialized if the ratio between
+// the two does not exceed `threshold`.
+llvm::SmallVector<RematerializationCandidate> GetRematerializationCandidates(
+    SairProgramOp program, int threshold,
+    const IterationSpaceAnalysis &iteration_spaces) {
+  llvm::SmallVector<RematerializationCandidate> candidates;
+  program.WalkComputeOpInstances([&](const ComputeOpInstance &user) {
+    if (user.is_copy()) return;
+    const IterationSpace &use_iter_space = iteration_spaces.Get(user);
+    if (!use_iter_space.fully_specified()) return;
+
+    mlir::ArrayAttr operand_attrs = user.GetDecisions().operands();
+    int num_domain_operands = user.GetSairOp().getDomain().size();
+    int num_operands = user.GetSairOp().ValueOperands().size();
+    for (int position = 0; position < num_operands; ++position) {
+      OperandInstance operand(user, position);
+      auto value = operand.GetValue();
+      if (!value.has_value() || value->defining_op().is_copy()) continue;
+      if (operand_attrs != nullptr &&
+          operand_attrs[num_domain_operands + position].isa<CopyAttr>()) {
+        continue;
+      }
+
+      // Only recompute sair.map operations without side effects whose storage
+      // is left to this pass.
+      ComputeOpInstance producer(value->defining_op());
+      auto map_op = dyn_cast<SairMapOp>(producer.GetDuplicatedOp());
+      if (map_op == nullptr ||
+          producer.Storage(value->result_number()) != nullptr) {
+        continue;
+      }
+      bool is_pure = llvm::all_of(
+          map_op.block().without_terminator(),
+          [](mlir::Operation &op) { return mlir::isMemoryEffectFree(&op); });
+      if (!is_pure) continue;
+
+      const IterationSpace &def_iter_space = iteration_spaces.Get(producer);
+      if (!def_iter_space.fully_specified() ||
+          FitsInRegisters(operand, iteration_spaces)) {
+        continue;
+      }
+      int rank = value->GetType().cast<ValueType>().Shape().NumDimensions();
+      MappingAttr communication_volume =
+          CommunicationVolume(rank, def_iter_space, use_iter_space);
+      if (NumBodyOps(map_op) > threshold * communication_volume.size()) {
+        continue;
+      }
+
+      mlir::ArrayAttr loop_nest =
+          GetRematerializedLoopNest(user, position, use_iter_space);
+      if (loop_nest == nullptr) continue;
+      candidates.push_back({user, position, loop_nest});
+    }
+  });
+  return candidates;
+}
+
+// Counts the operands of operation instances that use the results of
+// `producer`. Copies of the results and operands that do not specify their
+// source instance are conservatively counted as uses.
+int NumUses(const ComputeOpInstance &producer) {
+  mlir::Operation *op = producer.GetDuplicatedOp();
+  auto value_producer = dyn_cast<ValueProducerOp>(op);
+  int num_uses = 0;
+  for (mlir::OpResult result : op->getResults()) {
+    if (value_producer != nullptr) {
+      num_uses += value_producer.GetCopies(result.getResultNumber()).size();
+    }
+    for (mlir::OpOperand &use : result.getUses()) {
+      auto user = cast<SairOp>(use.getOwner());
+      if (!user.getInstances().has_value()) {
+        ++num_uses;
+        continue;
+      }
+      for (int i = 0, e = user.NumInstances(); i < e; ++i) {
+        mlir::ArrayAttr operands = user.GetDecisions(i).operands();
+        // Operands use the first instance of their producer by default.
+        if (operands == nullptr) {
+          num_uses += producer.index() == 0;
+          continue;
+        }
+        mlir::Attribute source = operands[use.getOperandNumber()];
+        if (source.isa<CopyAttr>()) continue;
+        auto instance = source.dyn_cast<InstanceAttr>();
+        if (instance == nullptr || instance.getValue() == producer.index()) {
+          ++num_uses;
+        }
+      }
+    }
+  }
+  return num_uses;
+}
+
+// Recomputes the operand producer in the loops of the user. If `retarget` is
+// set, the producer instance is moved to the loops of the user, otherwise a new
+// instance is added and the operand redirected to it. The rematerialized
+// instance shares the sequence number of the user so that it is sequenced
+// right before it.
+void Rematerialize(const RematerializationCandidate &candidate,
+                   bool retarget) {
+  mlir::MLIRContext *context = candidate.user.context();
+  OperandInstance operand(candidate.user, candidate.operand_position);
+  ComputeOpInstance producer(operand.GetValue()->defining_op());
+  DecisionsAttr producer_decisions = producer.GetDecisions();
+  SairOp sair_op = producer.GetSairOp();
+
+  if (retarget) {
+    producer.SetDecisions(DecisionsAttr::get(
+        candidate.user.GetDecisions().sequence(), candidate.loop_nest,
+        producer_decisions.storage(), producer_decisions.expansion(),
+        producer_decisions.copy_of(), producer_decisions.operands(), context));
+    return;
+  }
+
+  int instance = sair_op.NumInstances();
+  sair_op.AddInstance(DecisionsAttr::get(
+      candidate.user.GetDecisions().sequence(), candidate.loop_nest,
+      /*storage=*/nullptr, producer_decisions.expansion(), /*copy_of=*/nullptr,
+      producer_decisions.operands(), context));
+  SetOperandSource(candidate.user, candidate.operand_position,
+                   InstanceAttr::get(context, instance));
+}
+
 // Assigns the default storage to sair values. This uses registers when possible
 // and materializes the minimum amount of dimensions in RAM otherwise. Fails if
 // the sub-domain of dimensions to materialize is a dependent domain.
@@ -267,6 +483,12 @@ class DefaultStorage : public impl::DefaultStoragePassBase<DefaultStorage> {
       return;
     }
 
+    // Storage decisions do not change loop nests nor the sequence of
+    // operations. Rematerialization does, so RunOnProgram drops the analyses
+    // computed before it and the preserved ones are built on the final loop
+    // nests.
+    markAnalysesPreserved<IterationSpaceAnalysis, LoopFusionAnalysis,
+                          SequenceAnalysis>();
     getOperation().walk([&](SairProgramOp program) -> mlir::WalkResult {
       mlir::LogicalResult result = RunOnProgram(program);
       if (mlir::failed(result)) signalPassFailure();
@@ -275,7 +497,56 @@ class DefaultStorage : public impl::DefaultStoragePassBase<DefaultStorage> {
   }
 
  private:
+  // Recomputes cheap producers in the loops of their users instead of storing
+  // their results in memory. Returns true if any instance was added.
+  bool RematerializeCheapProducers(SairProgramOp program) {
+    auto &iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
+    // Collect candidates before adding instances, as this changes the set of
+    // compute op instances.
+    llvm::SmallVector<RematerializationCandidate> candidates =
+        GetRematerializationCandidates(program, rematerialization_threshold,
+                                       iteration_spaces);
+
+    // Producer instances that are only used by candidates are moved to the
+    // loops of their first candidate user instead of being left without uses.
+    // Producers that are themselves rematerialized users keep their loops as
+    // the loops of their own producers were computed from them.
+    llvm::DenseMap<ComputeOpInstance, int> num_candidate_uses;
+    for (const RematerializationCandidate &candidate : candidates) {
+      OperandInstance operand(candidate.user, candidate.operand_position);
+      ComputeOpInstance producer(operand.GetValue()->defining_op());
+      ++num_candidate_uses[producer];
+    }
+    llvm::DenseSet<ComputeOpInstance> retargeted;
+    for (const RematerializationCandidate &candidate : candidates) {
+      if (num_candidate_uses.count(candidate.user) > 0) continue;
+      OperandInstance operand(candidate.user, candidate.operand_position);
+      ComputeOpInstance producer(operand.GetValue()->defining_op());
+      if (num_candidate_uses[producer] != NumUses(producer)) continue;
+      retargeted.insert(producer);
+    }
+
+    for (const RematerializationCandidate &candidate : candidates) {
+      OperandInstance operand(candidate.user, candidate.operand_position);
+      ComputeOpInstance producer(operand.GetValue()->defining_op());
+      Rematerialize(candidate, retargeted.erase(producer));
+    }
+    // Retargeted instances moved to other loops and users read from new
+    // instances.
+    if (!candidates.empty()) iteration_spaces.InvalidateAll();
+    return !candidates.empty();
+  }
+
   mlir::LogicalResult RunOnProgram(SairProgramOp program) {
+    if (rematerialization_threshold > 0 &&
+        RematerializeCheapProducers(program)) {
+      // New instances are not known to analyses computed so far. Iteration
+      // spaces were already dropped and are recomputed on demand.
+      mlir::AnalysisManager::PreservedAnalyses preserved;
+      preserved.preserve<IterationSpaceAnalysis>();
+      getAnalysisManager().nest(program).invalidate(preserved);
+    }
+
     auto &iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
     auto &fusion_analysis = getChildAnalysis<LoopFusionAnalysis>(program);
     auto &storage_analysis = getChildAnalysis<StorageAnalysis>(program);
@@ -297,13 +568,20 @@ class DefaultStorage : public impl::DefaultStoragePassBase<DefaultStorage> {
     if (result.wasInterrupted()) return mlir::failure();
 
     // Assign all remaining values to register and intialize layout fields.
+    // Storage information is propagated at this point, so values related by
+    // propagation get the same defaults and decisions are merged in a single
+    // batch.
+    llvm::SmallVector<std::pair<ResultInstance, ValueStorage>> new_storages;
     program.WalkOpInstances([&](const OpInstance &op) {
       for (ResultInstance value : op.Results()) {
         if (!value.GetType().isa<ValueType>()) continue;
-        InitializeStorage(value, fusion_analysis, iteration_spaces,
-                          storage_analysis);
+        new_storages.emplace_back(
+            value,
+            GetInitialStorage(value, iteration_spaces, storage_analysis));
       }
     });
+    storage_analysis.MergeStorages(new_storages, fusion_analysis,
+                                   iteration_spaces);
 
     // Add layout dimensions when necessary.
     result = program.TryWalkOpInstances(
@@ -322,13 +600,16 @@ class DefaultStorage : public impl::DefaultStoragePassBase<DefaultStorage> {
     // occure when adding dimensions to buffers. When the buffer is used in
     // multiple places, only the place where the dimension is added will have
     // the layout set for the new dimensions and other places will be unknown.
+    new_storages.clear();
     program.WalkOpInstances([&](const OpInstance &op) {
       for (ResultInstance value : op.Results()) {
         if (!value.GetType().isa<ValueType>()) continue;
-        MakeLayoutFullySpecified(value, fusion_analysis, iteration_spaces,
-                                 storage_analysis);
+        new_storages.emplace_back(
+            value, GetFullySpecifiedStorage(value, storage_analysis));
       }
     });
+    storage_analysis.MergeStorages(new_storages, fusion_analysis,
+                                   iteration_spaces);
 
     if (mlir::failed(storage_analysis.VerifyAndMinimizeBufferLoopNests(
             fusion_analysis, iteration_spaces, sequence_analysis)) ||
@@ -399,6 +680,236 @@ class DefaultLoopNest : public impl::DefaultLoopNestPassBase<DefaultLoopNest> {
   }
 };
 
+// An operand to pack into a contiguous buffer, along with the number of outer
+// loops of its user that delimit the packed tile.
+struct PackingCandidate {
+  ComputeOpInstance user;
+  int operand_position;
+  int num_tile_loops;
+};
+
+// Returns the number of outer loops of the operand user that iterate over tiles
+// of the operand: loops that only index the operand and precede the first loop
+// the operand is invariant to. Returns std::nullopt if the operand is not
+// reused across loops, if tile loops cannot be expressed in the domain of the
+// operand or if the operand and its user do not share domain dimensions.
+std::optional<int> NumTileLoops(const OperandInstance &operand,
+                                const IterationSpace &use_iter_space) {
+  OpInstance user = operand.owner();
+  ResultInstance value = *operand.GetValue();
+  MappingAttr mapping = operand.Mapping();
+  int domain_size = user.domain_size();
+
+  // Only consider operands accessed with plain dimensions of the user domain
+  // that iterate on the same ranges.
+  for (int i = 0, e = mapping.size(); i < e; ++i) {
+    auto dim_expr = mapping.Dimension(i).dyn_cast<MappingDimExpr>();
+    if (dim_expr == nullptr) return std::nullopt;
+    if (value.defining_op().domain(i) != user.domain(dim_expr.dimension())) {
+      return std::nullopt;
+    }
+  }
+
+  llvm::SmallBitVector operand_dims = mapping.DependencyMask();
+  MappingAttr loops = use_iter_space.MappingToLoops();
+  for (int i = 0, e = loops.size(); i < e; ++i) {
+    llvm::SmallBitVector loop_dims =
+        loops.Dimension(i).DependencyMask(domain_size);
+    if (!loop_dims.anyCommon(operand_dims)) {
+      if (i == 0) return std::nullopt;
+      return i;
+    }
+    loop_dims.reset(operand_dims);
+    if (loop_dims.any()) return std::nullopt;
+  }
+  return std::nullopt;
+}
+
+// Computes the decisions of a copy of the operand value that is nested in the
+// tile loops of the operand user and stores the tile in a fresh buffer. The
+// buffer only covers the communication volume between the copy and the user so
+// that the user reads the tile from contiguous memory. Returns nullptr if the
+// tile covers the full operand and there is nothing to pack.
+DecisionsAttr GetPackingCopyDecisions(
+    const PackingCandidate &candidate,
+    const IterationSpaceAnalysis &iteration_spaces,
+    LoopFusionAnalysis &fusion_analysis, StorageAnalysis &storage_analysis) {
+  mlir::MLIRContext *context = candidate.user.context();
+  OperandInstance operand(candidate.user, candidate.operand_position);
+  ResultInstance value = *operand.GetValue();
+  int rank = value.GetType().cast<ValueType>().Shape().NumDimensions();
+  const IterationSpace &use_iter_space = iteration_spaces.Get(candidate.user);
+
+  // Express tile loops in the domain of the operand value.
+  MappingAttr tile_loops =
+      use_iter_space.MappingToLoops().Resize(candidate.num_tile_loops);
+  MappingAttr tile_iters = operand.Mapping().Inverse().Compose(tile_loops);
+  if (tile_iters.HasNoneExprs() || tile_iters.HasUnknownExprs()) {
+    return nullptr;
+  }
+  llvm::SmallVector<mlir::Attribute> prefix;
+  for (int i = 0; i < candidate.num_tile_loops; ++i) {
+    auto loop = candidate.user.Loops()[i].cast<LoopAttr>();
+    prefix.push_back(LoopAttr::get(loop.name(), tile_iters.Dimension(i),
+                                   loop.unroll(), loop.unroll_and_jam(),
+                                   context));
+  }
+  mlir::ArrayAttr loop_nest =
+      GetDefaultLoopNest(rank, prefix, fusion_analysis);
+
+  llvm::SmallVector<mlir::StringAttr> loop_names;
+  llvm::SmallVector<MappingExpr> iter_exprs;
+  for (mlir::Attribute attr : loop_nest) {
+    auto loop = attr.cast<LoopAttr>();
+    loop_names.push_back(loop.name());
+    iter_exprs.push_back(loop.iter());
+  }
+  IterationSpace copy_iter_space(
+      loop_names, MappingAttr::get(context, rank, iter_exprs),
+      /*fully_specified=*/true);
+
+  // Only store the part of the tile that is not covered by common loops.
+  MappingAttr communication_volume =
+      CommunicationVolume(rank, copy_iter_space, use_iter_space);
+  if (communication_volume.empty()) return nullptr;
+  MappingAttr layout = copy_iter_space.mapping()
+                           .Inverse()
+                           .Compose(communication_volume)
+                           .Canonicalize();
+  auto named_layout =
+      NamedMappingAttr::get(loop_names, layout).DropUnusedDims();
+
+  SairDialect *sair_dialect = candidate.user.GetSairDialect();
+  auto buffer = BufferAttr::get(sair_dialect->memory_attr(),
+                                storage_analysis.GetFreshBufferName(),
+                                named_layout, context);
+
+  // Copy the instance of the value the user was reading from.
+  mlir::Attribute copy_of = InstanceAttr::get(context, 0);
+  mlir::ArrayAttr operands = candidate.user.GetDecisions().operands();
+  if (operands != nullptr) {
+    int operand_number =
+        candidate.user.GetSairOp().getDomain().size() +
+        candidate.operand_position;
+    if (operands[operand_number].isa<InstanceAttr>()) {
+      copy_of = operands[operand_number];
+    }
+  }
+
+  // Share the sequence number of the user so that the copy is sequenced right
+  // before it.
+  return DecisionsAttr::get(
+      candidate.user.GetDecisions().sequence(), loop_nest,
+      mlir::ArrayAttr::get(context, {buffer}),
+      mlir::StringAttr::get(context, kCopyExpansionPattern), copy_of,
+      /*operands=*/nullptr, context);
+}
+
+// Appends a copy with the given decisions to the `copies` attribute of
+// `value_producer` for the given result. Returns the position of the copy.
+int AppendCopy(ValueProducerOp value_producer, int result,
+               DecisionsAttr decisions) {
+  mlir::MLIRContext *context = value_producer.getContext();
+  int num_results = value_producer->getNumResults();
+  auto copies_attr = value_producer->getAttrOfType<mlir::ArrayAttr>(
+      ValueProducerOp::kCopiesAttrName);
+  llvm::SmallVector<mlir::Attribute> all_copies;
+  if (copies_attr == nullptr) {
+    all_copies.append(num_results, mlir::ArrayAttr::get(context, {}));
+  } else {
+    llvm::append_range(all_copies, copies_attr.getValue());
+  }
+
+  auto result_copies = llvm::to_vector<4>(
+      all_copies[result].cast<mlir::ArrayAttr>().getValue());
+  result_copies.push_back(decisions);
+  all_copies[result] = mlir::ArrayAttr::get(context, result_copies);
+  value_producer->setAttr(ValueProducerOp::kCopiesAttrName,
+                          mlir::ArrayAttr::get(context, all_copies));
+  return result_copies.size() - 1;
+}
+
+// Redirects the operand of the candidate to the given copy of its value.
+void UseCopy(const PackingCandidate &candidate, int copy) {
+  SetOperandSource(candidate.user, candidate.operand_position,
+                   CopyAttr::get(candidate.user.context(), copy));
+}
+
+// Packs operands of sair.map and sair.map_reduce operations that are reused
+// across inner loops into contiguous buffers. Each packed operand gets a copy,
+// specified in the `copies` attribute of its producer, that is nested in the
+// outer loops of the user that index the operand. The copy stores a single
+// tile, sized by the communication volume between the copy and the user, so
+// that the inner loops stream contiguous memory. Packing is left to
+// sair-materialize-instances, the user operand being redirected to the copy in
+// its `operands` field.
+class PackOperands : public impl::PackOperandsPassBase<PackOperands> {
+ public:
+  void runOnOperation() override {
+    bool changed = false;
+    getOperation().walk(
+        [&](SairProgramOp program) { changed |= RunOnProgram(program); });
+    if (!changed) markAllAnalysesPreserved();
+  }
+
+ private:
+  // Packs operands of `program`. Returns true if any copy was added.
+  bool RunOnProgram(SairProgramOp program) {
+    auto &iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
+    auto &fusion_analysis = getChildAnalysis<LoopFusionAnalysis>(program);
+    auto &storage_analysis = getChildAnalysis<StorageAnalysis>(program);
+
+    // Collect candidates before modifying `copies` attributes, as adding copies
+    // changes the set of compute op instances.
+    llvm::SmallVector<PackingCandidate> candidates;
+    program.WalkComputeOpInstances([&](const ComputeOpInstance &op) {
+      if (op.is_copy()) return;
+      if (!isa<SairMapOp, SairMapReduceOp>(op.GetDuplicatedOp())) return;
+      const IterationSpace &iter_space = iteration_spaces.Get(op);
+      if (!iter_space.fully_specified()) return;
+
+      mlir::ArrayAttr operand_attrs = op.GetDecisions().operands();
+      int num_domain_operands = op.GetSairOp().getDomain().size();
+      int num_operands = op.GetSairOp().ValueOperands().size();
+      for (int position = 0; position < num_operands; ++position) {
+        OperandInstance operand(op, position);
+        auto value = operand.GetValue();
+        if (!value.has_value() || value->defining_op().is_copy()) continue;
+        if (!isa<ValueProducerOp>(value->defining_op().GetDuplicatedOp())) {
+          continue;
+        }
+        mlir::Type element_type =
+            value->GetType().cast<ValueType>().ElementType();
+        if (element_type.isa<mlir::IndexType>()) continue;
+        // Do not pack operands already reading from a copy.
+        if (operand_attrs != nullptr &&
+            operand_attrs[num_domain_operands + position].isa<CopyAttr>()) {
+          continue;
+        }
+
+        std::optional<int> num_tile_loops = NumTileLoops(operand, iter_space);
+        if (!num_tile_loops.has_value()) continue;
+        candidates.push_back({op, position, *num_tile_loops});
+      }
+    });
+
+    bool changed = false;
+    for (const PackingCandidate &candidate : candidates) {
+      DecisionsAttr decisions = GetPackingCopyDecisions(
+          candidate, iteration_spaces, fusion_analysis, storage_analysis);
+      if (decisions == nullptr) continue;
+      OperandInstance operand(candidate.user, candidate.operand_position);
+      ResultInstance value = *operand.GetValue();
+      auto value_producer =
+          cast<ValueProducerOp>(value.defining_op().GetDuplicatedOp());
+      int copy = AppendCopy(value_producer, value.result_number(), decisions);
+      UseCopy(candidate, copy);
+      changed = true;
+    }
+    return changed;
+  }
+};
+
 // Modifies the "sequence" attribute of all compute ops in the given program to
 // be the canonical sequence value inferred from use-def dependencies of Sair
 // values and available sequence attributes. The relative order is preserved but
@@ -460,6 +971,8 @@ class DefaultExpansion
     : public impl::DefaultExpansionPassBase<DefaultExpansion> {
  public:
   void runOnOperation() override {
+    // Expansion patterns do not influence Sair analyses.
+    markAllAnalysesPreserved();
     auto result = getOperation().walk([&](SairProgramOp program) {
       return program.TryWalkComputeOpInstances(
           [&](ComputeOpInstance &op) -> mlir::WalkResult {
@@ -494,6 +1007,10 @@ std::unique_ptr<mlir::Pass> CreateDefaultExpansionPass() {
   return std::make_unique<DefaultExpansion>();
 }
 
+std::unique_ptr<mlir::Pass> CreatePackOperandsPass() {
+  return std::make_unique<PackOperands>();
+}
+
 void CreateDefaultLoweringAttributesPipeline(mlir::OpPassManager *pm) {
   pm->addPass(CreateDefaultInstancePass());
   pm->addPass(CreateDefaultSequencePass());
@@ -50,6 +50,10 @@ std::unique_ptr<mlir::Pass> CreateDefaultStoragePass();
 // operations to use the default scalar implementation of the operation.
 std::unique_ptr<mlir::Pass> CreateDefaultExpansionPass();
 
+// Returns a pass that packs operands reused across inner loops into contiguous
+// tile buffers by adding copies to the `copies` attribute of their producers.
+std::unique_ptr<mlir::Pass> CreatePackOperandsPass();
+
 }  // namespace sair
 
 #endif  // SAIR_DEFAULT_LOWERING_ATTRIBUTES_H_
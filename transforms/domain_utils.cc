@@ -34,4 +34,25 @@ llvm::SmallVector<mlir::Value> CreatePlaceholderDomain(
   return domain;
 }
 
+RangeCache::RangeCache(SairProgramOp program) {
+  for (mlir::Operation &op : program.getBody().front()) {
+    auto static_range = dyn_cast<SairStaticRangeOp>(op);
+    if (static_range == nullptr) continue;
+    static_ranges_.try_emplace(static_range.getType(), static_range);
+  }
+}
+
+mlir::Value RangeCache::GetOrCreateStaticRange(mlir::Location loc,
+                                               StaticRangeType type,
+                                               mlir::OpBuilder &builder) {
+  mlir::Value &range = static_ranges_[type];
+  if (range == nullptr) {
+    range = builder.create<SairStaticRangeOp>(
+        loc, type,
+        /*instances=*/GetInstanceZeroOperandsSingleInstance(
+            builder.getContext(), 0));
+  }
+  return range;
+}
+
 }  // namespace sair
@@ -15,9 +15,11 @@
 #ifndef THIRD_PARTY_SAIR_TRANSFORMS_DOMAIN_UTILS_H_
 #define THIRD_PARTY_SAIR_TRANSFORMS_DOMAIN_UTILS_H_
 
+#include "llvm/ADT/DenseMap.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/Builders.h"
 #include "sair_op_interfaces.h"
+#include "sair_ops.h"
 
 namespace sair {
 
@@ -25,6 +27,35 @@ namespace sair {
 llvm::SmallVector<mlir::Value> CreatePlaceholderDomain(
     mlir::Location loc, DomainShapeAttr shape, mlir::OpBuilder &builder);
 
+// Interns the range operations of a Sair program so that transformations
+// creating ranges for loops share them instead of creating duplicates. Ranges
+// are indexed by loop name and, for static ranges, by type so that loops with
+// the same static bounds share a single sair.static_range operation.
+class RangeCache {
+ public:
+  // Registers the static ranges already present in `program`.
+  explicit RangeCache(SairProgramOp program);
+
+  // Returns the range registered for the loop or nullptr if there is none.
+  mlir::Value GetLoopRange(mlir::StringAttr loop_name) const {
+    return loop_ranges_.lookup(loop_name);
+  }
+
+  // Registers the range of a loop.
+  void AddLoopRange(mlir::StringAttr loop_name, mlir::Value range) {
+    loop_ranges_.try_emplace(loop_name, range);
+  }
+
+  // Returns a sair.static_range operation of the given type, creating it at
+  // the insertion point of `builder` if it does not exist yet.
+  mlir::Value GetOrCreateStaticRange(mlir::Location loc, StaticRangeType type,
+                                     mlir::OpBuilder &builder);
+
+ private:
+  llvm::DenseMap<mlir::Attribute, mlir::Value> loop_ranges_;
+  llvm::DenseMap<mlir::Type, mlir::Value> static_ranges_;
+};
+
 }  // namespace sair
 
 #endif  // THIRD_PARTY_SAIR_TRANSFORMS_DOMAIN_UTILS_H_
@@ -0,0 +1,281 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/IR/Value.h"
+#include "mlir/IR/Visitors.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "sair_attributes.h"
+#include "sair_op_interfaces.h"
+#include "sair_ops.h"
+#include "util.h"
+
+#define DEBUG_TYPE "sair-eliminate-dead-code"
+
+namespace sair {
+
+#define GEN_PASS_DEF_ELIMINATEDEADCODEPASS
+#include "transforms/lowering.h.inc"
+
+namespace {
+
+STATISTIC(NumErasedOps, "Number of dead Sair operations erased");
+STATISTIC(NumErasedResults, "Number of dead sair.map results erased");
+STATISTIC(NumErasedInputs, "Number of dead sair.map inputs erased");
+
+// Indicates if an operation of the body of `op` has side effects.
+bool HasSideEffectingBody(mlir::Operation *op) {
+  for (mlir::Region &region : op->getRegions()) {
+    mlir::WalkResult result = region.walk([](mlir::Operation *body_op) {
+      if (mlir::isMemoryEffectFree(body_op)) return mlir::WalkResult::advance();
+      return mlir::WalkResult::interrupt();
+    });
+    if (result.wasInterrupted()) return true;
+  }
+  return false;
+}
+
+// Computes which operations and values of a sair.program contribute to the
+// results of the program or to side effects. Liveness is computed at the
+// granularity of sair.map results and inputs, following the use-def chains of
+// map bodies. Use-def cycles through sair.fby operations are dead unless a live
+// operation uses one of the values of the cycle.
+class Liveness {
+ public:
+  explicit Liveness(SairProgramOp program);
+
+  // Indicates if an operation of the program or of a sair.map body is live.
+  bool IsLive(mlir::Operation *op) const { return live_ops_.contains(op); }
+
+  // Indicates if a Sair value or a value of a sair.map body is live.
+  bool IsLive(mlir::Value value) const { return live_values_.contains(value); }
+
+ private:
+  // Marks a value as live and registers it for propagation.
+  void MarkLive(mlir::Value value);
+
+  // Marks an operation as live, along with all the values it uses. Does not
+  // apply to sair.map operations, whose liveness is tracked per result.
+  void MarkLive(mlir::Operation *op);
+
+  // Marks the domain of a sair.map operation as live.
+  void MarkMapLive(SairMapOp op);
+
+  // Propagates liveness from a value to the values it is computed from.
+  void Propagate(mlir::Value value);
+
+  llvm::DenseSet<mlir::Operation *> live_ops_;
+  llvm::DenseSet<mlir::Value> live_values_;
+  llvm::SmallVector<mlir::Value> work_list_;
+};
+
+Liveness::Liveness(SairProgramOp program) {
+  for (mlir::Operation &op : program.getBody().front()) {
+    // Copies are only referenced from attributes, keep the values they copy.
+    if (auto value_producer = dyn_cast<ValueProducerOp>(op)) {
+      for (int i = 0, e = op.getNumResults(); i < e; ++i) {
+        if (!value_producer.GetCopies(i).empty()) MarkLive(op.getResult(i));
+      }
+    }
+
+    if (auto map_op = dyn_cast<SairMapOp>(op)) {
+      for (mlir::Operation &body_op : map_op.block().without_terminator()) {
+        if (mlir::isMemoryEffectFree(&body_op)) continue;
+        MarkMapLive(map_op);
+        MarkLive(&body_op);
+      }
+    } else if (op.getNumResults() == 0) {
+      // Operations without results, such as sair.exit and sair.to_memref, are
+      // only useful for their side effects.
+      MarkLive(&op);
+    } else if (HasSideEffectingBody(&op)) {
+      // Other operations with a body, such as sair.map_reduce, are kept as a
+      // whole when their body has side effects.
+      MarkLive(&op);
+    }
+  }
+
+  while (!work_list_.empty()) {
+    Propagate(work_list_.pop_back_val());
+  }
+}
+
+void Liveness::MarkLive(mlir::Value value) {
+  if (live_values_.insert(value).second) work_list_.push_back(value);
+}
+
+void Liveness::MarkLive(mlir::Operation *op) {
+  assert(!isa<SairMapOp>(op));
+  if (!live_ops_.insert(op).second) return;
+  op->walk([&](mlir::Operation *nested_op) {
+    for (mlir::Value operand : nested_op->getOperands()) MarkLive(operand);
+  });
+}
+
+void Liveness::MarkMapLive(SairMapOp op) {
+  if (!live_ops_.insert(op).second) return;
+  for (mlir::Value dimension : op.getDomain()) MarkLive(dimension);
+}
+
+void Liveness::Propagate(mlir::Value value) {
+  if (auto arg = value.dyn_cast<mlir::BlockArgument>()) {
+    auto map_op = dyn_cast<SairMapOp>(arg.getOwner()->getParentOp());
+    if (map_op == nullptr) return;
+    int domain_size = map_op.getDomain().size();
+    if (arg.getArgNumber() < domain_size) return;
+    MarkLive(map_op.getInputs()[arg.getArgNumber() - domain_size]);
+    return;
+  }
+
+  mlir::Operation *defining_op = value.getDefiningOp();
+  if (auto map_op = dyn_cast<SairMapOp>(defining_op)) {
+    MarkMapLive(map_op);
+    int result = value.cast<mlir::OpResult>().getResultNumber();
+    MarkLive(map_op.block().getTerminator()->getOperand(result));
+    return;
+  }
+  MarkLive(defining_op);
+}
+
+// Erases dead results and inputs of a live sair.map operation, along with dead
+// operations of its body. Returns true if the operation was modified.
+bool SimplifyLiveMap(SairMapOp op, const Liveness &liveness,
+                     mlir::OpBuilder &builder) {
+  int domain_size = op.getDomain().size();
+
+  llvm::SmallBitVector kept_results(op.getNumResults());
+  for (int i = 0, e = op.getNumResults(); i < e; ++i) {
+    if (liveness.IsLive(op.getResult(i))) kept_results.set(i);
+  }
+  llvm::SmallVector<mlir::Operation *> dead_body_ops;
+  for (mlir::Operation &body_op : op.block().without_terminator()) {
+    if (!liveness.IsLive(&body_op)) dead_body_ops.push_back(&body_op);
+  }
+  llvm::SmallVector<int> dead_inputs;
+  for (int i = 0, e = op.getInputs().size(); i < e; ++i) {
+    if (!liveness.IsLive(op.block_inputs()[i])) dead_inputs.push_back(i);
+  }
+  if (kept_results.all() && dead_body_ops.empty() && dead_inputs.empty()) {
+    return false;
+  }
+
+  // Simplify the body.
+  mlir::Operation *return_op = op.block().getTerminator();
+  llvm::SmallVector<mlir::Value> returned_values;
+  for (int i : kept_results.set_bits()) {
+    returned_values.push_back(return_op->getOperand(i));
+  }
+  builder.setInsertionPoint(return_op);
+  builder.create<SairReturnOp>(return_op->getLoc(), returned_values);
+  return_op->erase();
+  for (mlir::Operation *body_op : llvm::reverse(dead_body_ops)) {
+    body_op->erase();
+  }
+
+  // Erase inputs.
+  llvm::SmallVector<mlir::Value> inputs = op.getInputs();
+  llvm::SmallVector<mlir::Attribute> mappings;
+  llvm::append_range(mappings, op.getMappingArray());
+  mlir::ArrayAttr instances = op.getInstancesAttr();
+  for (int input : llvm::reverse(dead_inputs)) {
+    op.block().eraseArgument(domain_size + input);
+    inputs.erase(inputs.begin() + input);
+    mappings.erase(mappings.begin() + input);
+    if (instances != nullptr) {
+      instances = EraseOperandFromDecisions(instances, domain_size + input);
+    }
+  }
+
+  // Create the new operation.
+  llvm::SmallVector<mlir::Type> result_types;
+  for (int i : kept_results.set_bits()) {
+    result_types.push_back(op.getResult(i).getType());
+  }
+  instances = MkArrayAttrMapper<DecisionsAttr>(
+      MapStorage(MkArrayAttrFilter(kept_results)))(instances);
+  mlir::ArrayAttr copies = MkArrayAttrFilter(kept_results)(op.getCopiesAttr());
+  builder.setInsertionPoint(op);
+  auto new_op = builder.create<SairMapOp>(
+      op.getLoc(), result_types, op.getDomain(),
+      builder.getArrayAttr(mappings), inputs, op.getShape(), instances, copies);
+  new_op.getBody().takeBody(op.getBody());
+  for (auto [old_pos, new_result] :
+       llvm::zip(kept_results.set_bits(), new_op.getResults())) {
+    op.getResult(old_pos).replaceAllUsesWith(new_result);
+  }
+
+  NumErasedResults += op.getNumResults() - kept_results.count();
+  NumErasedInputs += dead_inputs.size();
+  op.erase();
+  return true;
+}
+
+// Erases operations of a sair.program that do not contribute to the results of
+// the program or to side effects, in a single sweep over the whole program.
+// Contrary to canonicalization patterns, that only look at the uses of one
+// operation at a time, this also erases use-def cycles going through sair.fby
+// operations, as well as chains of operations whose only user is a dead
+// operation. Erasing dead operations also erases the range operations that only
+// define dimensions of dead operations.
+class EliminateDeadCode
+    : public impl::EliminateDeadCodePassBase<EliminateDeadCode> {
+  void runOnOperation() override {
+    mlir::OpBuilder builder(&getContext());
+    bool changed = false;
+    getOperation().walk([&](SairProgramOp program) {
+      Liveness liveness(program);
+
+      llvm::SmallVector<mlir::Operation *> dead_ops;
+      llvm::SmallVector<SairMapOp> live_maps;
+      for (mlir::Operation &op : program.getBody().front()) {
+        if (!liveness.IsLive(&op)) {
+          dead_ops.push_back(&op);
+        } else if (auto map_op = dyn_cast<SairMapOp>(op)) {
+          live_maps.push_back(map_op);
+        }
+      }
+
+      // Dead operations may form cycles and use dead results of live
+      // operations, drop references before erasing anything.
+      for (mlir::Operation *op : dead_ops) op->dropAllReferences();
+      for (SairMapOp map_op : live_maps) {
+        changed |= SimplifyLiveMap(map_op, liveness, builder);
+      }
+      for (mlir::Operation *op : dead_ops) op->erase();
+      NumErasedOps += dead_ops.size();
+      changed |= !dead_ops.empty();
+    });
+    if (!changed) markAllAnalysesPreserved();
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateEliminateDeadCodePass() {
+  return std::make_unique<EliminateDeadCode>();
+}
+
+}  // namespace sair
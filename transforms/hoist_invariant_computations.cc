@@ -0,0 +1,341 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <memory>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+#include "sair_attributes.h"
+#include "sair_op_interfaces.h"
+#include "sair_ops.h"
+#include "sair_types.h"
+#include "storage.h"
+
+#define DEBUG_TYPE "sair-hoist-invariant-computations"
+
+namespace sair {
+
+#define GEN_PASS_DEF_HOISTINVARIANTCOMPUTATIONSPASS
+#include "transforms/lowering.h.inc"
+
+namespace {
+
+STATISTIC(NumHoistedOps, "Number of operations hoisted out of sair.map bodies");
+
+// Returns the domain prefixes computations can be hoisted to. Bit `k` is set
+// if the first `k` loops of `loop_nest` iterate exactly on the first `k`
+// dimensions of a domain of size `domain_size`, in any order. Returns an empty
+// vector if loops do not map one to one to domain dimensions.
+llvm::SmallBitVector HoistingLevels(mlir::ArrayAttr loop_nest,
+                                    int domain_size) {
+  if (loop_nest == nullptr) return {};
+  int num_loops = loop_nest.size();
+  if (num_loops != domain_size) return {};
+  llvm::SmallBitVector levels(domain_size + 1);
+  levels.set(0);
+  llvm::SmallBitVector covered_dims(domain_size);
+  for (auto en : llvm::enumerate(loop_nest.getAsRange<LoopAttr>())) {
+    auto dim_expr = en.value().iter().dyn_cast<MappingDimExpr>();
+    if (dim_expr == nullptr || covered_dims.test(dim_expr.dimension())) {
+      return {};
+    }
+    covered_dims.set(dim_expr.dimension());
+    if (covered_dims.find_first_unset() == en.index() + 1 ||
+        covered_dims.all()) {
+      levels.set(en.index() + 1);
+    }
+  }
+  return levels;
+}
+
+// Analysis of the operations of a sair.map body that only depend on a prefix
+// of the map domain.
+class InvariantOps {
+ public:
+  // Computes the smallest domain prefix each operation of `op` body can
+  // execute in. `levels` indicates which prefixes of the domain can be
+  // hoisted to, as returned by `HoistingLevels`.
+  InvariantOps(SairMapOp op, const llvm::SmallBitVector &levels);
+
+  // Number of dimensions in the domain prefix the hoisted operations execute
+  // in. Equals the domain size if there is nothing to hoist.
+  int level() const { return level_; }
+
+  // Operations to move to the new sair.map, in their original order.
+  llvm::ArrayRef<mlir::Operation *> ops() const { return ops_.getArrayRef(); }
+
+  // Indicates if `op` is hoisted.
+  bool IsHoisted(mlir::Operation *op) const { return ops_.contains(op); }
+
+ private:
+  int level_;
+  llvm::SetVector<mlir::Operation *> ops_;
+};
+
+InvariantOps::InvariantOps(SairMapOp op, const llvm::SmallBitVector &levels) {
+  int domain_size = op.getDomain().size();
+  level_ = domain_size;
+
+  // Dimensions each value of the body depends on. Values missing from the map
+  // are defined by operations that cannot be hoisted.
+  llvm::DenseMap<mlir::Value, llvm::SmallBitVector> dependencies;
+  for (int i = 0; i < domain_size; ++i) {
+    llvm::SmallBitVector mask(domain_size);
+    mask.set(i);
+    dependencies.try_emplace(op.block().getArgument(i), mask);
+  }
+  for (ValueOperand operand : op.ValueOperands()) {
+    // Values produced by sair.fby are carried by the loops of `op` and must
+    // only be used by `op`. Operations using them are not hoisted.
+    if (operand.value().getDefiningOp<SairFbyOp>() != nullptr) continue;
+    dependencies.try_emplace(op.block_inputs()[operand.position()],
+                             operand.Mapping().DependencyMask());
+  }
+
+  // Operations that can execute in a strict prefix of the domain. Inner loops
+  // may run zero times, so hoisted operations must be speculatable.
+  llvm::SmallVector<mlir::Operation *> candidates;
+  int max_level = 0;
+  for (mlir::Operation &body_op : op.block().without_terminator()) {
+    if (body_op.getNumRegions() != 0 || !mlir::isPure(&body_op)) {
+      continue;
+    }
+    llvm::SmallBitVector mask(domain_size);
+    bool hoistable = true;
+    for (mlir::Value operand : body_op.getOperands()) {
+      if (operand.getParentRegion() != &op.getBody()) continue;
+      auto it = dependencies.find(operand);
+      if (it == dependencies.end()) {
+        hoistable = false;
+        break;
+      }
+      mask |= it->second;
+    }
+    if (!hoistable) continue;
+    for (mlir::Value result : body_op.getResults()) {
+      dependencies.try_emplace(result, mask);
+    }
+
+    // Constants are rematerialized in each body that uses them rather than
+    // hoisted.
+    if (mlir::matchPattern(&body_op, mlir::m_Constant())) continue;
+    int level = mask.find_last() + 1;
+    while (!levels.test(level)) ++level;
+    if (level == domain_size) continue;
+    candidates.push_back(&body_op);
+    max_level = std::max(max_level, level);
+  }
+
+  if (candidates.empty()) return;
+  // Hoist to the innermost profitable level. Operations that could execute in
+  // an even smaller domain are hoisted further when processing the new
+  // sair.map.
+  level_ = max_level;
+  ops_.insert(candidates.begin(), candidates.end());
+}
+
+// Moves the operations of `op` body listed in `invariant_ops` to a new
+// sair.map operation, with a domain restricted to the first
+// `invariant_ops.level()` dimensions of `op` domain. Values flowing from
+// hoisted operations to the rest of the body are stored in registers. Inputs of
+// `op` only used by hoisted operations are removed. Returns the new operation.
+SairMapOp HoistOps(SairMapOp op, const InvariantOps &invariant_ops,
+                   mlir::OpBuilder &builder) {
+  mlir::MLIRContext *context = op.getContext();
+  int domain_size = op.getDomain().size();
+  int level = invariant_ops.level();
+  DecisionsAttr decisions = op.GetDecisions(0);
+
+  // Values used outside of hoisted operations, that the new operation returns.
+  llvm::SetVector<mlir::Value> escaping_values;
+  for (mlir::Operation *body_op : invariant_ops.ops()) {
+    for (mlir::OpOperand &use : body_op->getUses()) {
+      if (invariant_ops.IsHoisted(use.getOwner())) continue;
+      escaping_values.insert(use.get());
+    }
+  }
+
+  // Collect the inputs used by hoisted operations.
+  llvm::SmallVector<ValueAccess> inputs;
+  llvm::SmallVector<mlir::Attribute> operand_attrs;
+  llvm::SmallVector<int> input_positions;
+  llvm::SmallBitVector used_inputs(op.getInputs().size());
+  for (mlir::Operation *body_op : invariant_ops.ops()) {
+    for (mlir::Value value : body_op->getOperands()) {
+      auto arg = value.dyn_cast<mlir::BlockArgument>();
+      if (arg == nullptr || arg.getOwner() != &op.block()) continue;
+      if (arg.getArgNumber() < domain_size) continue;
+      used_inputs.set(arg.getArgNumber() - domain_size);
+    }
+  }
+  if (decisions.operands() != nullptr) {
+    llvm::append_range(operand_attrs,
+                       decisions.operands().getValue().take_front(level));
+  }
+  for (ValueOperand operand : op.ValueOperands()) {
+    if (!used_inputs.test(operand.position())) continue;
+    inputs.push_back(
+        {operand.value(), operand.Mapping().ResizeUseDomain(level)});
+    input_positions.push_back(operand.position());
+    if (decisions.operands() != nullptr) {
+      operand_attrs.push_back(
+          decisions.operands().getValue()[domain_size + operand.position()]);
+    }
+  }
+
+  // Create the new operation.
+  DomainShapeAttr shape = op.getShape().Prefix(level);
+  llvm::SmallVector<mlir::Type> result_types;
+  for (mlir::Value value : escaping_values) {
+    result_types.push_back(ValueType::get(shape, value.getType()));
+  }
+  llvm::SmallVector<mlir::Attribute> storage(
+      escaping_values.size(), GetRegister0DBuffer(context));
+  auto new_decisions = DecisionsAttr::get(
+      decisions.sequence(),
+      builder.getArrayAttr(decisions.loop_nest().getValue().take_front(level)),
+      builder.getArrayAttr(storage), decisions.expansion(),
+      /*copy_of=*/nullptr,
+      decisions.operands() == nullptr ? nullptr
+                                      : builder.getArrayAttr(operand_attrs),
+      context);
+  builder.setInsertionPoint(op);
+  auto new_op = builder.create<SairMapOp>(
+      op.getLoc(), result_types, op.getDomain().take_front(level), inputs,
+      shape, builder.getArrayAttr({new_decisions}), /*copies=*/nullptr);
+
+  // Populate the body, cloning constants as needed.
+  mlir::IRMapping mapping;
+  for (int i = 0; i < level; ++i) {
+    mapping.map(op.block().getArgument(i), new_op.block().getArgument(i));
+  }
+  for (auto en : llvm::enumerate(input_positions)) {
+    mapping.map(op.block_inputs()[en.value()],
+                new_op.block_inputs()[en.index()]);
+  }
+  builder.setInsertionPointToStart(&new_op.block());
+  for (mlir::Operation *body_op : invariant_ops.ops()) {
+    for (mlir::Value value : body_op->getOperands()) {
+      if (mapping.contains(value)) continue;
+      mlir::Operation *definition = value.getDefiningOp();
+      if (definition == nullptr || definition->getBlock() != &op.block()) {
+        continue;
+      }
+      builder.clone(*definition, mapping);
+    }
+    builder.clone(*body_op, mapping);
+  }
+  llvm::SmallVector<mlir::Value> returned_values;
+  for (mlir::Value value : escaping_values) {
+    returned_values.push_back(mapping.lookup(value));
+  }
+  builder.create<SairReturnOp>(op.getLoc(), returned_values);
+
+  // Forward results of the new operation to the original one.
+  auto prefix_mapping =
+      MappingAttr::GetIdentity(context, level, domain_size);
+  llvm::SmallVector<mlir::Attribute> mappings;
+  llvm::append_range(mappings, op.getMappingArray());
+  llvm::SmallVector<mlir::Attribute> op_operand_attrs;
+  if (decisions.operands() != nullptr) {
+    llvm::append_range(op_operand_attrs, decisions.operands().getValue());
+  }
+  for (auto [value, result] :
+       llvm::zip(escaping_values, new_op.getResults())) {
+    op.getInputsMutable().append(result);
+    mappings.push_back(prefix_mapping);
+    if (decisions.operands() != nullptr) {
+      op_operand_attrs.push_back(InstanceAttr::get(context, 0));
+    }
+    mlir::Value argument = op.block().addArgument(value.getType(), op.getLoc());
+    value.replaceAllUsesWith(argument);
+  }
+  for (mlir::Operation *body_op : llvm::reverse(invariant_ops.ops())) {
+    body_op->erase();
+  }
+
+  // Remove inputs that were only used by hoisted operations.
+  llvm::SmallVector<int> dead_inputs;
+  for (int position : used_inputs.set_bits()) {
+    if (!op.block_inputs()[position].use_empty()) continue;
+    dead_inputs.push_back(position);
+  }
+  for (int position : llvm::reverse(dead_inputs)) {
+    op.getInputsMutable().erase(position);
+    op.block().eraseArgument(domain_size + position);
+    mappings.erase(mappings.begin() + position);
+    if (decisions.operands() != nullptr) {
+      op_operand_attrs.erase(op_operand_attrs.begin() + domain_size + position);
+    }
+  }
+  op.setMappingArrayAttr(builder.getArrayAttr(mappings));
+  if (decisions.operands() != nullptr) {
+    op.SetDecisions(0, UpdateOperands(decisions, op_operand_attrs));
+  }
+
+  NumHoistedOps += invariant_ops.ops().size();
+  return new_op;
+}
+
+// Moves computations of sair.map bodies that only depend on outer loops into
+// separate sair.map operations with smaller domains, so that they are not
+// recomputed at each iteration of inner loops. Expects operations to be
+// sair.map with exactly one instance and loops that each iterate on a single
+// dimension, as produced by sair-lower-to-map.
+class HoistInvariantComputations
+    : public impl::HoistInvariantComputationsPassBase<
+          HoistInvariantComputations> {
+  void runOnOperation() override {
+    mlir::OpBuilder builder(&getContext());
+    llvm::SmallVector<SairMapOp> work_list;
+    getOperation().walk([&](SairMapOp op) { work_list.push_back(op); });
+
+    bool changed = false;
+    while (!work_list.empty()) {
+      SairMapOp op = work_list.pop_back_val();
+      if (!op.HasExactlyOneInstance()) continue;
+      llvm::SmallBitVector levels = HoistingLevels(
+          op.GetDecisions(0).loop_nest(), op.getDomain().size());
+      if (levels.empty()) continue;
+      InvariantOps invariant_ops(op, levels);
+      if (invariant_ops.ops().empty()) continue;
+      // The new operation may contain computations that can be hoisted even
+      // further.
+      work_list.push_back(HoistOps(op, invariant_ops, builder));
+      changed = true;
+    }
+    if (!changed) markAllAnalysesPreserved();
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateHoistInvariantComputationsPass() {
+  return std::make_unique<HoistInvariantComputations>();
+}
+
+}  // namespace sair
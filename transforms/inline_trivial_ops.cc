@@ -14,6 +14,7 @@
 
 #include <memory>
 
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
@@ -50,27 +51,10 @@ bool IsTrivialSairMap(SairMapOp op) {
   return true;
 }
 
-// Replaces the first trivial Sair Op in the function with the contents of its
-// body. The results of the trivial Op are wrapped into a 0D Sair value. This
-// processes only one trivial Op since the rewrite it performs can make other
-// Ops trivial, and since it can invalidate the pointers to the operations if we
-// stored them during a pre-pass. Returns "true" if it modified the input
-// function, "false" otherwise.
-bool InlineTrivialSairOp(mlir::func::FuncOp function) {
-  // Find the first map or map_reduce operation with 0d domain and 0d inputs.
-  SairMapOp trivial_op;
-  mlir::WalkResult walk_result = function.walk([&trivial_op](SairMapOp op) {
-    if (IsTrivialSairMap(op)) {
-      trivial_op = op;
-      return mlir::WalkResult::interrupt();
-    }
-    return mlir::WalkResult::advance();
-  });
-  if (!walk_result.wasInterrupted()) {
-    return false;
-  }
-  assert(trivial_op);
-
+// Replaces a trivial Sair Op with the contents of its body. The results of the
+// trivial Op are wrapped into 0D Sair values, which are returned and may make
+// their users trivial.
+llvm::SmallVector<mlir::Value, 8> InlineTrivialSairOp(SairMapOp trivial_op) {
   // Collect the source non-Sair scalars that are used to construct Sair values.
   llvm::SmallVector<mlir::Value, 8> source_values;
   auto trivial_op_operands = trivial_op.ValueOperands();
@@ -125,7 +109,7 @@ bool InlineTrivialSairOp(mlir::func::FuncOp function) {
     }
   }
   trivial_operation->erase();
-  return true;
+  return result_values;
 }
 
 // MLIR pass that replaces trivial Sair ops with the content of their body.
@@ -133,17 +117,33 @@ class InlineTrivialSairOpsPass
     : public impl::InlineTrivialSairOpsPassBase<InlineTrivialSairOpsPass> {
   void runOnOperation() override {
     mlir::func::FuncOp function = getOperation();
-    // Iteratively find the first trivial Sair Op and inline it, which may
-    // create new trivial Ops. The iteration stops when no trivial Ops are
-    // present in the function.
-    while (InlineTrivialSairOp(function)) {
-      // Intentionally empty.
+    // Inline trivial Sair Ops in a single traversal. Inlining an Op may make
+    // its users trivial, in which case they are appended to the worklist. Sair
+    // programs are graph regions so users may appear before the Op they use.
+    llvm::SmallVector<SairMapOp> worklist;
+    llvm::DenseSet<mlir::Operation *> queued;
+    auto enqueue_if_trivial = [&](SairMapOp op) {
+      if (IsTrivialSairMap(op) && queued.insert(op).second) {
+        worklist.push_back(op);
+      }
+    };
+    function.walk(enqueue_if_trivial);
+    bool changed = !worklist.empty();
+
+    for (size_t i = 0; i < worklist.size(); ++i) {
+      for (mlir::Value result : InlineTrivialSairOp(worklist[i])) {
+        for (mlir::Operation *user : result.getUsers()) {
+          if (auto map_op = dyn_cast<SairMapOp>(user)) {
+            enqueue_if_trivial(map_op);
+          }
+        }
+      }
     }
 
     // Inline trivial sair.program operations. A sair.program operation is
     // trivial if it only contains sair.from_scalar operations apart from its
     // terminator.
-    function.walk([](SairProgramOp op) {
+    function.walk([&](SairProgramOp op) {
       for (mlir::Operation &sair_op :
            op.getBody().front().without_terminator()) {
         if (!isa<SairFromScalarOp>(&sair_op)) return;
@@ -157,7 +157,9 @@ class InlineTrivialSairOpsPass
         op.getResult(i).replaceAllUsesWith(from_scalar_op.getValue());
       }
       op.erase();
+      changed = true;
     });
+    if (!changed) markAllAnalysesPreserved();
   }
 };
 
@@ -20,19 +20,24 @@
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/SCF/Utils/Utils.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Location.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/OperationSupport.h"
 #include "mlir/IR/PatternMatch.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/UseDefLists.h"
 #include "mlir/IR/Value.h"
 #include "mlir/Pass/Pass.h"
+#include "mlir/Rewrite/FrozenRewritePatternSet.h"
 #include "mlir/Support/LLVM.h"
 #include "mlir/Support/LogicalResult.h"
 #include "mlir/Transforms/RegionUtils.h"
@@ -51,12 +56,40 @@ namespace sair {
 
 namespace {
 
+// Runtime function instrumented loops report to. It takes the position of the
+// loop name in the kProfileLoopsAttrName attribute of the enclosing function,
+// the number of cycles spent in the loop and the loop trip count, all as i64.
+constexpr llvm::StringRef kProfileLoopFunction = "sair_profile_loop";
+
+// Function attribute listing the names of the loops instrumented in the
+// function.
+constexpr llvm::StringRef kProfileLoopsAttrName = "sair.profile_loops";
+
+// Options controlling the code generated for each loop.
+struct LoopCodegenOptions {
+  // If not null, loops are instrumented and their names are appended to this
+  // list.
+  llvm::SmallVectorImpl<mlir::Attribute> *profiled_loops = nullptr;
+  // Upper bounds for which loops with a dynamic upper bound are specialized.
+  llvm::ArrayRef<int64_t> specialized_upper_bounds;
+};
+
 // Adds canonicalization patterns from Ops to `list.
 template <typename... Ops>
 void getAllPatterns(mlir::RewritePatternSet &list, mlir::MLIRContext *ctx) {
   (Ops::getCanonicalizationPatterns(list, ctx), ...);
 }
 
+// Returns the canonicalization patterns of all Sair operations.
+mlir::RewritePatternSet GetCanonicalizationPatterns(mlir::MLIRContext *ctx) {
+  mlir::RewritePatternSet patterns(ctx);
+  getAllPatterns<
+#define GET_OP_LIST
+#include "sair_ops.cc.inc"
+      >(patterns, ctx);
+  return patterns;
+}
+
 // Keeps track of the operations to process to introduce loops. Maintains two
 // work lists, one for sair operations to canonicalize and one for sair.map
 // operations to lower. Keeps `sequence_analysis` updated with op additions and
@@ -64,18 +97,17 @@ void getAllPatterns(mlir::RewritePatternSet &list, mlir::MLIRContext *ctx) {
 // of compute operations are updated in the analysis on every addition and
 // deletion. Note that the op attributes are not updated until `AssignInferred`
 // is called on `sequence_analysis`.
+//
+// Canonicalization patterns are frozen and indexed by root operation name so
+// that simplifying an operation only visits patterns that may apply to it.
 class Driver : public mlir::PatternRewriter,
                public mlir::RewriterBase::Listener {
  public:
   Driver(mlir::MLIRContext *ctx, SequenceAnalysis &sequence_analysis)
       : PatternRewriter(ctx),
-        canonicalization_patterns_(ctx),
+        canonicalization_patterns_(GetCanonicalizationPatterns(ctx)),
         sequence_analysis_(sequence_analysis) {
     setListener(this);
-    getAllPatterns<
-#define GET_OP_LIST
-#include "sair_ops.cc.inc"
-        >(canonicalization_patterns_, ctx);
   }
 
   // Applies canonicalization and dead-code elimination to operations that
@@ -90,16 +122,7 @@ class Driver : public mlir::PatternRewriter,
         continue;
       }
 
-      for (const auto &pattern :
-           canonicalization_patterns_.getNativePatterns()) {
-        if (pattern->getRootKind().has_value() &&
-            pattern->getRootKind() != operation->getName()) {
-          continue;
-        }
-        if (mlir::succeeded(pattern->matchAndRewrite(operation, *this))) {
-          break;
-        }
-      }
+      ApplyCanonicalizationPatterns(operation);
     }
   }
 
@@ -122,6 +145,41 @@ class Driver : public mlir::PatternRewriter,
   }
 
  private:
+  // Applies the first canonicalization pattern that matches `operation`.
+  // Patterns specific to the operation name are tried before patterns matching
+  // any operation.
+  void ApplyCanonicalizationPatterns(mlir::Operation *operation) {
+    const auto &op_specific_patterns =
+        canonicalization_patterns_.getOpSpecificNativePatterns();
+    auto it = op_specific_patterns.find(operation->getName());
+    if (it != op_specific_patterns.end()) {
+      for (const mlir::RewritePattern *pattern : it->second) {
+        if (mlir::succeeded(pattern->matchAndRewrite(operation, *this))) {
+          return;
+        }
+      }
+    }
+    for (const auto &pattern :
+         canonicalization_patterns_.getMatchAnyOpNativePatterns()) {
+      if (mlir::succeeded(pattern->matchAndRewrite(operation, *this))) return;
+    }
+  }
+
+  // Forgets the pending in-place update of `op`, if any.
+  void ErasePendingUpdate(mlir::Operation *op) {
+    auto it = pending_updates_.find(op);
+    if (it == pending_updates_.end()) return;
+    for (mlir::Operation *dependency : it->second) {
+      auto dependents_it = pending_dependents_.find(dependency);
+      if (dependents_it == pending_dependents_.end()) continue;
+      llvm::erase(dependents_it->second, op);
+      if (dependents_it->second.empty()) {
+        pending_dependents_.erase(dependents_it);
+      }
+    }
+    pending_updates_.erase(it);
+  }
+
   // Hook called when a new operation is created.
   void notifyOperationInserted(mlir::Operation *op,
                                InsertPoint previous) override {
@@ -151,14 +209,15 @@ class Driver : public mlir::PatternRewriter,
 
     simplify_work_list_.remove(op);
     map_ops_work_list_.remove(op);
-    pending_updates_.erase(op);
+    ErasePendingUpdate(op);
 
-    for (auto &[_, dependencies] : pending_updates_) {
-      for (int i = 0; i < dependencies.size(); ++i) {
-        if (dependencies[i] != op) continue;
-        std::swap(dependencies[i], dependencies.back());
-        dependencies.pop_back();
+    // Remove `op` from the dependencies of pending updates.
+    if (auto it = pending_dependents_.find(op);
+        it != pending_dependents_.end()) {
+      for (mlir::Operation *dependent : it->second) {
+        llvm::erase(pending_updates_.find(dependent)->second, op);
       }
+      pending_dependents_.erase(it);
     }
 
     if (auto compute_op = dyn_cast<ComputeOp>(op)) {
@@ -191,6 +250,9 @@ class Driver : public mlir::PatternRewriter,
       dependencies.push_back(defining_op);
     }
 
+    for (mlir::Operation *dependency : dependencies) {
+      pending_dependents_[dependency].push_back(op);
+    }
     auto res = pending_updates_.insert({op, std::move(dependencies)});
     assert(res.second);
     (void)res;  // Avoid variable unused errors in release build.
@@ -206,21 +268,27 @@ class Driver : public mlir::PatternRewriter,
     for (mlir::Operation *dependency : it->second) {
       AddOperation(dependency);
     }
-    pending_updates_.erase(it);
+    ErasePendingUpdate(op);
   }
 
   // Hook called when an in-place update that was announced by
   // `startOpModification` is cancelled.
   void cancelOpModification(mlir::Operation *op) override {
-    pending_updates_.erase(op);
+    ErasePendingUpdate(op);
   }
 
-  mlir::RewritePatternSet canonicalization_patterns_;
+  mlir::FrozenRewritePatternSet canonicalization_patterns_;
   llvm::SetVector<mlir::Operation *> simplify_work_list_;
   llvm::SetVector<mlir::Operation *> map_ops_work_list_;
 
+  // Operations updated in place, mapped to the operations defining their
+  // operands before the update.
   llvm::DenseMap<mlir::Operation *, llvm::SmallVector<mlir::Operation *, 4>>
       pending_updates_;
+  // Reverse index of `pending_updates_`: maps operations to the operations
+  // being updated that depend on them.
+  llvm::DenseMap<mlir::Operation *, llvm::SmallVector<mlir::Operation *, 1>>
+      pending_dependents_;
 
   SequenceAnalysis &sequence_analysis_;
 };
@@ -369,7 +437,7 @@ mlir::ArrayAttr EraseDimensionFromLoopNest(
     }
     new_loop_nest.push_back(LoopAttr::get(
         loop.name(), MappingDimExpr::get(old_dimension - 1, context),
-        loop.unroll(), context));
+        loop.unroll(), loop.unroll_and_jam(), context));
   }
   return mlir::ArrayAttr::get(context, new_loop_nest);
 }
@@ -470,6 +538,105 @@ mlir::scf::ForOp CreateForOp(mlir::Location loc, mlir::Value lower_bound,
   return for_op;
 }
 
+// Surrounds `for_op` with cycle counter reads and reports the cycles spent in
+// the loop, along with its trip count, to the kProfileLoopFunction runtime
+// function. The loop is identified by the position of its name in
+// `profiled_loops`.
+void InstrumentLoop(mlir::scf::ForOp for_op, LoopAttr loop,
+                    llvm::SmallVectorImpl<mlir::Attribute> &profiled_loops,
+                    Driver &driver) {
+  mlir::OpBuilder::InsertionGuard guard(driver);
+  mlir::Location loc = for_op.getLoc();
+  mlir::Type i64_type = driver.getI64Type();
+  auto read_cycle_counter = [&]() -> mlir::Value {
+    return driver
+        .create<mlir::LLVM::CallIntrinsicOp>(
+            loc, i64_type, driver.getStringAttr("llvm.readcyclecounter"),
+            mlir::ValueRange())
+        ->getResult(0);
+  };
+
+  driver.setInsertionPoint(for_op);
+  mlir::Value start = read_cycle_counter();
+  driver.setInsertionPointAfter(for_op);
+  mlir::Value end = read_cycle_counter();
+
+  mlir::Value cycles = driver.create<mlir::arith::SubIOp>(loc, end, start);
+  mlir::Value range = driver.create<mlir::arith::SubIOp>(
+      loc, for_op.getUpperBound(), for_op.getLowerBound());
+  mlir::Value trip_count =
+      driver.create<mlir::arith::CeilDivSIOp>(loc, range, for_op.getStep());
+  // Loops whose upper bound is below their lower bound run zero times.
+  mlir::Value zero = driver.create<mlir::arith::ConstantIndexOp>(loc, 0);
+  trip_count = driver.create<mlir::arith::MaxSIOp>(loc, trip_count, zero);
+  mlir::Value loop_id = driver.create<mlir::arith::ConstantOp>(
+      loc, driver.getI64IntegerAttr(profiled_loops.size()));
+  driver.create<mlir::func::CallOp>(
+      loc, kProfileLoopFunction, mlir::TypeRange(),
+      llvm::ArrayRef<mlir::Value>(
+          {loop_id, cycles,
+           driver.create<mlir::arith::IndexCastOp>(loc, i64_type, trip_count)
+               .getResult()}));
+  profiled_loops.push_back(loop.name());
+}
+
+// Returns true if `for_op` should be versioned for likely upper bounds. Only
+// innermost loops with a constant lower bound and a dynamic upper bound are
+// versioned: specialized versions then have a constant trip count and nested
+// versioned loops do not multiply the number of versions. This excludes
+// normalized strips, whose lower bound is the start of the strip.
+bool ShouldVersion(mlir::scf::ForOp for_op) {
+  if (!mlir::getConstantIntValue(for_op.getLowerBound()).has_value() ||
+      mlir::getConstantIntValue(for_op.getUpperBound()).has_value()) {
+    return false;
+  }
+  mlir::WalkResult result = for_op.getBody()->walk(
+      [](mlir::scf::ForOp) { return mlir::WalkResult::interrupt(); });
+  return !result.wasInterrupted();
+}
+
+// Creates a version of `for_op` for each of the given `upper_bounds`, with a
+// constant upper bound, and dispatches between versions at runtime with a chain
+// of scf.if operations. `for_op` is kept as the fallback version. Returns all
+// versions, starting with specialized ones.
+llvm::SmallVector<mlir::scf::ForOp> VersionLoop(
+    mlir::scf::ForOp for_op, llvm::ArrayRef<int64_t> upper_bounds,
+    Driver &driver) {
+  mlir::OpBuilder::InsertionGuard guard(driver);
+  mlir::Location loc = for_op.getLoc();
+  llvm::SmallVector<mlir::scf::ForOp> versions;
+  for (int64_t upper_bound : upper_bounds) {
+    driver.setInsertionPoint(for_op);
+    mlir::Value constant_bound =
+        driver.create<mlir::arith::ConstantIndexOp>(loc, upper_bound);
+    mlir::Value condition = driver.create<mlir::arith::CmpIOp>(
+        loc, mlir::arith::CmpIPredicate::eq, for_op.getUpperBound(),
+        constant_bound);
+    auto if_op = driver.create<mlir::scf::IfOp>(
+        loc, for_op.getResultTypes(), condition, /*withElseRegion=*/true);
+    for_op->replaceAllUsesWith(if_op.getResults());
+
+    // The scf.if builder only creates terminators if there are no results.
+    auto append_to_branch = [&](mlir::Block *block, mlir::scf::ForOp loop) {
+      if (for_op.getNumResults() == 0) {
+        loop->moveBefore(block->getTerminator());
+        return;
+      }
+      loop->moveBefore(block, block->end());
+      driver.setInsertionPointToEnd(block);
+      driver.create<mlir::scf::YieldOp>(loc, loop.getResults());
+    };
+
+    auto specialized = cast<mlir::scf::ForOp>(driver.clone(*for_op));
+    specialized.getUpperBoundMutable().assign(constant_bound);
+    append_to_branch(if_op.thenBlock(), specialized);
+    append_to_branch(if_op.elseBlock(), for_op);
+    versions.push_back(specialized);
+  }
+  versions.push_back(for_op);
+  return versions;
+}
+
 // Use builder to create a variable of the given type. The variable value will
 // not be used. Returns nullptr if the type is not an integer or float type.
 mlir::Value GetValueOfType(mlir::Location loc, mlir::Type type,
@@ -485,14 +652,14 @@ mlir::Value GetValueOfType(mlir::Location loc, mlir::Type type,
 }
 
 // Updates users of a value after introducing a loop in the sair.map operation
-// producing the value.
-mlir::LogicalResult UpdateLoopUser(SairMapOp old_op, SairMapOp new_op,
-                                   mlir::Value old_value, mlir::Value new_value,
+// producing the value. The type of `value` must already be updated.
+mlir::LogicalResult UpdateLoopUser(SairMapOp op, mlir::Value value,
                                    int dimension, Driver &driver) {
-  // Use an early-inc iterator to avoid invalidating the iterator when
-  // destroying uses.
-  auto uses = llvm::make_early_inc_range(old_value.getUses());
-  for (mlir::OpOperand &use : uses) {
+  // Collect uses first as updating users creates new uses of `value`.
+  llvm::SmallVector<mlir::OpOperand *, 4> uses;
+  for (mlir::OpOperand &use : value.getUses()) uses.push_back(&use);
+  for (mlir::OpOperand *use_ptr : uses) {
+    mlir::OpOperand &use = *use_ptr;
     SairOp user = cast<SairOp>(use.getOwner());
     int operand_position = use.getOperandNumber() - user.getDomain().size();
 
@@ -501,30 +668,32 @@ mlir::LogicalResult UpdateLoopUser(SairMapOp old_op, SairMapOp new_op,
         mapping.Dimension(dimension).cast<MappingDimExpr>().dimension();
 
     if (auto proj_last = dyn_cast<SairProjLastOp>(use.getOwner())) {
-      EraseDimension(proj_last, user_dimension, new_value, driver);
+      EraseDimension(proj_last, user_dimension, value, driver);
       continue;
     }
 
     SairFbyOp fby_op = cast<SairFbyOp>(use.getOwner());
-    assert(fby_op.getValue() == old_value);
+    assert(fby_op.getValue() == value);
 
     for (mlir::Operation *fby_user : fby_op.getResult().getUsers()) {
-      if (fby_user == old_op || fby_user == new_op) continue;
+      if (fby_user == op) continue;
       // TODO(ulysse): update the insert copies pass to introduce copies
       return fby_user->emitError()
              << "insert copies between sair.fby and users located after "
                 "producing loops before calling loop introduction";
     }
 
-    EraseDimension(fby_op, user_dimension, new_value, driver);
+    EraseDimension(fby_op, user_dimension, value, driver);
   }
 
   return mlir::success();
 }
 
-// Replaces the innermost dimension of the domain by a loop.
+// Replaces the innermost dimension of the domain by a loop, generated according
+// to `options`.
 mlir::LogicalResult IntroduceLoop(SairMapOp op,
                                   const StorageAnalysis &storage_analysis,
+                                  const LoopCodegenOptions &options,
                                   Driver &driver) {
   auto *sair_dialect = static_cast<SairDialect *>(op->getDialect());
   llvm::ArrayRef<mlir::Attribute> loop_nest =
@@ -581,45 +750,20 @@ mlir::LogicalResult IntroduceLoop(SairMapOp op,
   llvm::APInt step(64, range.Step());
   mlir::Block::iterator for_insertion_point = driver.getInsertionPoint();
 
-  // Create the new sair.map operation.
-  driver.setInsertionPoint(op);
-  mlir::ArrayAttr new_loop_nest = EraseDimensionFromLoopNest(
-      loop_nest.drop_back(), dimension, driver.getContext());
-  DecisionsAttr decisions = op.GetDecisions(0);
-  auto new_decisions = DecisionsAttr::get(
-      /*sequence=*/decisions.sequence(),
-      /*loop_nest=*/new_loop_nest,
-      /*storage=*/decisions.storage(),
-      /*expansion=*/decisions.expansion(),
-      /*copy_of=*/nullptr,
-      /*operands=*/EraseOperandFromArray(decisions.operands(), dimension),
-      op.getContext());
-  SairMapOp new_op = driver.create<SairMapOp>(
-      op.getLoc(),
-      /*result_types=*/EraseDimension(op.getResultTypes(), dimension),
-      /*domain=*/EraseValue(op.getDomain(), dimension),
-      /*mappings_array=*/driver.getArrayAttr(mappings),
-      /*inputs=*/inputs,
-      /*shape=*/EraseDimension(op.getShape(), dimension),
-      /*instances=*/driver.getArrayAttr({new_decisions}),
-      /*copies=*/nullptr);
-  new_op.getBody().takeBody(op.getBody());
-
-  // Position of the sair.map in the results of the scf.for operation.
+  // Register sair.fby operands before updating the operation. Block arguments
+  // are not renumbered until the loop is created.
   llvm::SmallVector<int, 4> results_pos(op.getNumResults(), -1);
-
-  // Register sair.fby operands.
   llvm::SmallVector<mlir::Value, 4> iter_args_init;
   llvm::SmallVector<mlir::Value, 4> iter_args;
   llvm::SmallVector<mlir::Value, 4> iter_args_result;
 
-  mlir::Operation *terminator = new_op.block().getTerminator();
+  mlir::Operation *terminator = op.block().getTerminator();
   for (ValueOperand operand : op.ValueOperands()) {
     SairFbyOp fby = dyn_cast<SairFbyOp>(operand.value().getDefiningOp());
     if (fby == nullptr) continue;
 
     mlir::Value value =
-        new_op.block().getArgument(operand.position() + op.getDomain().size());
+        op.block().getArgument(operand.position() + op.getDomain().size());
     iter_args_init.push_back(value);
     iter_args.push_back(value);
 
@@ -636,20 +780,45 @@ mlir::LogicalResult IntroduceLoop(SairMapOp op,
     iter_args_result.push_back(terminator->getOperand(result_pos));
   }
 
+  // Update the sair.map operation in place rather than creating a new one. This
+  // avoids moving the body and updating the sequence analysis for each loop.
+  mlir::ArrayAttr new_loop_nest = EraseDimensionFromLoopNest(
+      loop_nest.drop_back(), dimension, driver.getContext());
+  DecisionsAttr decisions = op.GetDecisions(0);
+  auto new_decisions = DecisionsAttr::get(
+      /*sequence=*/decisions.sequence(),
+      /*loop_nest=*/new_loop_nest,
+      /*storage=*/decisions.storage(),
+      /*expansion=*/decisions.expansion(),
+      /*copy_of=*/nullptr,
+      /*operands=*/EraseOperandFromArray(decisions.operands(), dimension),
+      op.getContext());
+  llvm::SmallVector<mlir::Type, 4> result_types =
+      EraseDimension(op.getResultTypes(), dimension);
+  driver.modifyOpInPlace(op, [&]() {
+    op.getDomainMutable().erase(dimension);
+    op.getInputsMutable().assign(inputs);
+    op.setMappingArrayAttr(driver.getArrayAttr(mappings));
+    op.setShapeAttr(EraseDimension(op.getShape(), dimension));
+    op.setInstancesAttr(driver.getArrayAttr({new_decisions}));
+    for (auto [result, type] : llvm::zip(op.getResults(), result_types)) {
+      result.setType(type);
+    }
+  });
+
   // Replace results.
-  driver.setInsertionPoint(&new_op.block(), for_insertion_point);
+  driver.setInsertionPoint(&op.block(), for_insertion_point);
   for (int i = 0, e = op.getNumResults(); i < e; ++i) {
-    if (mlir::failed(UpdateLoopUser(op, new_op, op.getResult(i),
-                                    new_op.getResult(i), dimension, driver))) {
+    if (mlir::failed(UpdateLoopUser(op, op.getResult(i), dimension, driver))) {
       return mlir::failure();
     }
     // Use loop-carried values to project results out of the loop.
     if (results_pos[i] >= 0) continue;
-    mlir::Type type = new_op.block().getTerminator()->getOperand(i).getType();
+    mlir::Type type = terminator->getOperand(i).getType();
     mlir::Value init = GetValueOfType(op.getLoc(), type, driver);
     if (init == nullptr) return mlir::failure();
 
-    mlir::Value result = new_op.block().getTerminator()->getOperand(i);
+    mlir::Value result = terminator->getOperand(i);
     iter_args_init.push_back(init);
     iter_args.push_back(nullptr);
     results_pos[i] = iter_args_result.size();
@@ -657,19 +826,39 @@ mlir::LogicalResult IntroduceLoop(SairMapOp op,
   }
 
   // Create the scf.for operation.
-  mlir::Value old_index = new_op.getBody().getArgument(dimension);
+  mlir::Value old_index = op.block().getArgument(dimension);
   mlir::scf::ForOp for_op = CreateForOp(
       op.getLoc(), lower_bound, upper_bound, step, old_index, iter_args_init,
       iter_args, iter_args_result, results_pos, driver);
-  if (loop.unroll()) {
-    if (mlir::failed(mlir::loopUnrollByFactor(
-            for_op, loop.unroll().getValue().getZExtValue())))
-      return failure();
+  // Instrument before versioning and unrolling so that all versions and
+  // epilogue loops, if any, are counted.
+  if (options.profiled_loops != nullptr) {
+    InstrumentLoop(for_op, loop, *options.profiled_loops, driver);
   }
-  new_op.getBody().eraseArgument(dimension);
-
-  // Erase the old operation.
-  driver.eraseOp(op);
+  llvm::SmallVector<mlir::scf::ForOp> versions = {for_op};
+  if (ShouldVersion(for_op)) {
+    versions = VersionLoop(for_op, options.specialized_upper_bounds, driver);
+  }
+  bool versioned = versions.size() > 1;
+  for (mlir::scf::ForOp version : versions) {
+    // Inner loops are already introduced at this point, so unroll-and-jam
+    // replicates the body of inner loops instead of the inner loops themselves.
+    // It requires a constant trip count, so the fallback version of a versioned
+    // loop is left as is.
+    mlir::IntegerAttr factor = loop.unroll_and_jam();
+    if (factor != nullptr && !(versioned && version == for_op)) {
+      if (mlir::failed(mlir::loopUnrollJamByFactor(version, factor.getInt()))) {
+        return op.emitError() << "unable to unroll and jam loop " << loop.name()
+                              << " by a factor of " << factor.getInt();
+      }
+    }
+    if (loop.unroll()) {
+      if (mlir::failed(mlir::loopUnrollByFactor(
+              version, loop.unroll().getValue().getZExtValue())))
+        return failure();
+    }
+  }
+  op.block().eraseArgument(dimension);
   return mlir::success();
 }
 
@@ -801,7 +990,8 @@ bool CanFuse(mlir::ArrayAttr lhs, mlir::ArrayAttr rhs) {
 // neigbors if possible.
 mlir::LogicalResult IntroduceLoopOrFuse(
     SairMapOp op, const StorageAnalysis &storage_analysis,
-    const SequenceAnalysis &sequence_analysis, Driver &driver) {
+    const SequenceAnalysis &sequence_analysis,
+    const LoopCodegenOptions &options, Driver &driver) {
   auto op_instance =
       ComputeOpInstance::Unique(cast<ComputeOp>(op.getOperation()));
   ComputeOpInstance prev_op = sequence_analysis.PrevOp(op_instance);
@@ -823,12 +1013,29 @@ mlir::LogicalResult IntroduceLoopOrFuse(
   } else if (!curr_loop_nest.empty() &&
              !IsPrefix(curr_loop_nest, prev_loop_nest) &&
              !IsPrefix(curr_loop_nest, next_loop_nest)) {
-    return IntroduceLoop(op, storage_analysis, driver);
+    return IntroduceLoop(op, storage_analysis, options, driver);
   }
 
   return mlir::success();
 }
 
+// Checks that the kProfileLoopFunction runtime function is declared with the
+// expected signature in the symbol table enclosing `function`.
+mlir::LogicalResult VerifyProfileLoopDeclaration(mlir::func::FuncOp function) {
+  mlir::MLIRContext *context = function.getContext();
+  auto callee = mlir::SymbolTable::lookupNearestSymbolFrom<mlir::func::FuncOp>(
+      function, mlir::StringAttr::get(context, kProfileLoopFunction));
+  mlir::Type i64_type = mlir::IntegerType::get(context, 64);
+  auto expected_type =
+      mlir::FunctionType::get(context, {i64_type, i64_type, i64_type}, {});
+  if (callee == nullptr || callee.getFunctionType() != expected_type) {
+    return function.emitError()
+           << "loop instrumentation requires a declaration of @"
+           << kProfileLoopFunction << " with type " << expected_type;
+  }
+  return mlir::success();
+}
+
 // Replaces iteration dimensions in sair.map and sair.map_reduce operation by
 // loops, converting sair.map_reduce operation into sair.map operations in the
 // process. Fails if operations operand depend on any dimension,  if operations
@@ -836,7 +1043,8 @@ mlir::LogicalResult IntroduceLoopOrFuse(
 // the same sair.program.
 class IntroduceLoops : public impl::IntroduceLoopsPassBase<IntroduceLoops> {
   // Introduce loops for a sair.program operation.
-  void IntroduceProgramLoops(SairProgramOp program) {
+  void IntroduceProgramLoops(SairProgramOp program,
+                             const LoopCodegenOptions &options) {
     auto &sequence_analysis = getChildAnalysis<SequenceAnalysis>(program);
     Driver driver(&getContext(), sequence_analysis);
     auto storage_analysis = getChildAnalysis<StorageAnalysis>(program);
@@ -849,7 +1057,8 @@ class IntroduceLoops : public impl::IntroduceLoopsPassBase<IntroduceLoops> {
 
     while (SairMapOp op = driver.PopMapOp()) {
       if (mlir::failed(IntroduceLoopOrFuse(op, storage_analysis,
-                                           sequence_analysis, driver))) {
+                                           sequence_analysis, options,
+                                           driver))) {
         signalPassFailure();
         return;
       }
@@ -859,8 +1068,26 @@ class IntroduceLoops : public impl::IntroduceLoopsPassBase<IntroduceLoops> {
   }
 
   void runOnOperation() override {
-    // Retreive a a sorted list of SairMap operations.
-    getOperation().walk([&](SairProgramOp op) { IntroduceProgramLoops(op); });
+    mlir::func::FuncOp function = getOperation();
+    if (instrument &&
+        mlir::failed(VerifyProfileLoopDeclaration(function))) {
+      signalPassFailure();
+      return;
+    }
+
+    llvm::SmallVector<mlir::Attribute> profiled_loops;
+    LoopCodegenOptions options;
+    if (instrument) options.profiled_loops = &profiled_loops;
+    llvm::SmallVector<int64_t> specialized_upper_bounds =
+        llvm::to_vector(specialize_upper_bounds);
+    options.specialized_upper_bounds = specialized_upper_bounds;
+    function.walk(
+        [&](SairProgramOp op) { IntroduceProgramLoops(op, options); });
+
+    if (!profiled_loops.empty()) {
+      function->setAttr(kProfileLoopsAttrName,
+                        mlir::ArrayAttr::get(&getContext(), profiled_loops));
+    }
   }
 };
 
@@ -34,7 +34,7 @@ class LowerProjAny : public impl::LowerProjAnyPassBase<LowerProjAny> {
     auto result = getOperation().walk([&](SairProjAnyOp op)
                                           -> mlir::WalkResult {
       builder.setInsertionPoint(op);
-      const auto &iteration_spaces =
+      auto &iteration_spaces =
           getChildAnalysis<IterationSpaceAnalysis>(op->getParentOp());
 
       auto source = cast<SairOp>(op.getValue().getDefiningOp());
@@ -113,6 +113,9 @@ class LowerProjAny : public impl::LowerProjAnyPassBase<LowerProjAny> {
                                .ResizeUseDomain(user_domain_size));
       }
 
+      // Users now read from other operations, so their inferred iteration
+      // spaces may change.
+      iteration_spaces.Invalidate(OpInstance::Unique(op));
       op.erase();
       return mlir::success();
     });
@@ -93,6 +93,7 @@ std::unique_ptr<mlir::Pass> CreateLowerToLLVMPass() {
 }
 
 void CreateSairToLoopConversionPipeline(mlir::OpPassManager *pm) {
+  pm->addPass(CreateEliminateDeadCodePass());
   pm->addPass(CreateLowerMapReducePass());
   pm->addPass(CreateMaterializeBuffersPass());
   // Canonicalize removes non-compute operations for values converted to
@@ -101,6 +102,7 @@ void CreateSairToLoopConversionPipeline(mlir::OpPassManager *pm) {
   pm->addPass(CreateNormalizeLoopsPass());
   pm->addPass(CreateLowerProjAnyPass());
   pm->addPass(CreateLowerToMapPass());
+  pm->addPass(CreateHoistInvariantComputationsPass());
   pm->addPass(CreateIntroduceLoopsPass());
   pm->addPass(CreateInlineTrivialOpsPass());
 }
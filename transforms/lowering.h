@@ -24,6 +24,11 @@
 
 namespace sair {
 
+// Returns a pass that erases Sair operations, sair.map results and sair.map
+// inputs that do not contribute to the program results or side effects.
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateEliminateDeadCodePass();
+
 // Returns a pass that lowers sair.map_reduce operations into sair.map,
 // sair.proj_last and sair.fby operations.
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
@@ -49,6 +54,11 @@ CreateMaterializeBuffersPass();
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
 CreateMaterializeInstancesPass();
 
+// Returns a pass that moves computations of sair.map bodies that only depend on
+// outer loops into new sair.map operations with smaller domains.
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateHoistInvariantComputationsPass();
+
 // Replaces iteration dimensions by loops in sair.map and sair.map_reduce
 // operations.
 std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
@@ -13,9 +13,11 @@
 // limitations under the License.
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Pass/Pass.h"
+#include "expansion.h"
 #include "loop_nest.h"
 #include "sair_dialect.h"
 #include "sair_op_interfaces.h"
@@ -41,9 +43,12 @@ mlir::ArrayAttr PointwiseLoopNest(llvm::ArrayRef<mlir::StringAttr> loop_names,
   loops.reserve(loop_names.size());
   for (int i = 0, e = loop_names.size(); i < e; ++i) {
     auto dim_expr = MappingDimExpr::get(i, context);
-    mlir::IntegerAttr unroll = fusion_analysis.GetClass(loop_names[i])
-                                   .GetUnrollAttr(*builder.getContext());
-    loops.push_back(LoopAttr::get(loop_names[i], dim_expr, unroll, context));
+    const LoopFusionClass &fusion_class =
+        fusion_analysis.GetClass(loop_names[i]);
+    loops.push_back(LoopAttr::get(loop_names[i], dim_expr,
+                                  fusion_class.GetUnrollAttr(*context),
+                                  fusion_class.GetUnrollAndJamAttr(*context),
+                                  context));
   }
   return builder.getArrayAttr(loops);
 }
@@ -92,15 +97,11 @@ std::pair<mlir::SmallVector<int64_t>, ValueRange> GetMemRefShape(
                          loops_to_domain, map_body, builder);
   for (const auto &params : range_parameters) {
     int step = params.step;
-    if (params.begin.is<mlir::Attribute>() &&
-        params.end.is<mlir::Attribute>()) {
-      // Handle constant dimension.
-      int beg = params.begin.get<mlir::Attribute>()
-                    .cast<mlir::IntegerAttr>()
-                    .getInt();
-      int end =
-          params.end.get<mlir::Attribute>().cast<mlir::IntegerAttr>().getInt();
-      memref_shape.push_back(llvm::divideCeil(end - beg, step));
+    if (params.max_extent.has_value()) {
+      // Handle dimensions with a static size or a static upper bound, such as
+      // strips of a static range. Bounded dimensions are allocated to their
+      // maximal size.
+      memref_shape.push_back(llvm::divideCeil(*params.max_extent, step));
     } else {
       memref_shape.push_back(mlir::ShapedType::kDynamic);
       // Handle dynamic dimensions.
@@ -208,9 +209,11 @@ mlir::Value AllocateBuffer(const Buffer &buffer,
   return alloc;
 }
 
-// Insert a load from a buffer for the operand `operand_pos` of `op`.
+// Insert a load from a buffer for the operand `operand_pos` of `op`. If
+// `prefetch` is set, the load uses the `load_prefetch` expansion pattern.
 void InsertLoad(ComputeOp op, int operand_pos, const Buffer &buffer,
-                ValueAccess memref, const LoopFusionAnalysis &fusion_analysis,
+                ValueAccess memref, bool prefetch,
+                const LoopFusionAnalysis &fusion_analysis,
                 const IterationSpaceAnalysis &iteration_spaces,
                 const StorageAnalysis &storage_analysis,
                 SequenceAnalysis &sequence_analysis, mlir::OpBuilder &builder) {
@@ -248,7 +251,9 @@ void InsertLoad(ComputeOp op, int operand_pos, const Buffer &buffer,
   auto decisions = DecisionsAttr::get(
       /*sequence=*/nullptr, /*loop_nest=*/loop_nest,
       /*storage=*/builder.getArrayAttr({loaded_storage}),
-      /*expansion=*/builder.getStringAttr(kLoadExpansionPattern),
+      /*expansion=*/
+      builder.getStringAttr(prefetch ? kLoadPrefetchExpansionPattern
+                                     : kLoadExpansionPattern),
       /*copy_of=*/nullptr,
       /*operands=*/GetInstanceZeroOperands(context, load_domain.size() + 1),
       context);
@@ -293,9 +298,11 @@ void InsertLoad(ComputeOp op, int operand_pos, const Buffer &buffer,
   operand.SetMapping(new_operand.mapping);
 }
 
-// Insert a store for the result `result_pos` of `op`.
+// Insert a store for the result `result_pos` of `op`. If `nontemporal` is set,
+// the store bypasses caches.
 void InsertStore(ComputeOp op, int result_pos, const Buffer &buffer,
-                 ValueAccess memref, const LoopFusionAnalysis &fusion_analysis,
+                 ValueAccess memref, bool nontemporal,
+                 const LoopFusionAnalysis &fusion_analysis,
                  const IterationSpaceAnalysis &iteration_spaces,
                  const StorageAnalysis &storage_analysis,
                  SequenceAnalysis &sequence_analysis,
@@ -326,7 +333,9 @@ void InsertStore(ComputeOp op, int result_pos, const Buffer &buffer,
       PointwiseLoopNest(op_iter_space.loop_names(), fusion_analysis, builder);
   auto decisions = DecisionsAttr::get(
       /*sequence=*/nullptr, /*loop_nest=*/loop_nest, /*storage=*/nullptr,
-      /*expansion=*/builder.getStringAttr(kStoreExpansionPattern),
+      /*expansion=*/
+      builder.getStringAttr(nontemporal ? kStoreNonTemporalExpansionPattern
+                                        : kStoreExpansionPattern),
       /*copy_of=*/nullptr,
       /*operands=*/
       GetInstanceZeroOperands(op.getContext(), store_domain.size() + 2),
@@ -347,16 +356,51 @@ void InsertStore(ComputeOp op, int result_pos, const Buffer &buffer,
   op_instance.SetStorage(result_pos, GetRegister0DBuffer(op.getContext()));
 }
 
+// Returns true if `buffer` is an external buffer that the program only writes
+// to. The memref of the buffer must only be imported with sair.to_memref
+// operations so that no other buffer importing the same memref reads it.
+// Distinct memrefs are assumed not to alias.
+bool IsWriteOnlyExternalBuffer(const Buffer &buffer) {
+  if (!buffer.is_external() || !buffer.reads().empty()) return false;
+  auto from_scalar = buffer.import_op()
+                         .MemRef()
+                         .value()
+                         .getDefiningOp<SairFromScalarOp>();
+  if (from_scalar == nullptr) return false;
+  for (mlir::Operation *user : from_scalar.getValue().getUsers()) {
+    auto other_from_scalar = dyn_cast<SairFromScalarOp>(user);
+    if (other_from_scalar == nullptr) return false;
+    for (mlir::Operation *import_op : other_from_scalar->getUsers()) {
+      if (!isa<SairToMemRefOp>(import_op)) return false;
+    }
+  }
+  return true;
+}
+
 // Implements storage attributes by replacing Sair values with memrefs.
 class MaterializeBuffers
     : public impl::MaterializeBuffersPassBase<MaterializeBuffers> {
   void RunOnProgram(SairProgramOp program) {
     mlir::MLIRContext *context = &getContext();
     mlir::OpBuilder builder(context);
-    auto storage_analysis = getChildAnalysis<StorageAnalysis>(program);
-    auto sequence_analysis = getChildAnalysis<SequenceAnalysis>(program);
-    auto fusion_analysis = getChildAnalysis<LoopFusionAnalysis>(program);
-    auto iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
+    auto &storage_analysis = getChildAnalysis<StorageAnalysis>(program);
+    auto &sequence_analysis = getChildAnalysis<SequenceAnalysis>(program);
+    auto &fusion_analysis = getChildAnalysis<LoopFusionAnalysis>(program);
+    auto &iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
+    // Operations are rewritten while the analysis is queried.
+    iteration_spaces.ComputeAll(program);
+
+    // Values written to an external buffer that is never read in the program
+    // are not needed in cache. Decide before inserting loads and stores as
+    // they add users to memrefs.
+    llvm::SmallPtrSet<const Buffer *, 4> nontemporal_buffers;
+    if (nontemporal_stores) {
+      for (auto &[name, buffer] : storage_analysis.buffers()) {
+        if (IsWriteOnlyExternalBuffer(buffer)) {
+          nontemporal_buffers.insert(&buffer);
+        }
+      }
+    }
 
     builder.setInsertionPointToStart(&program.getBody().front());
     for (auto &[name, buffer] : storage_analysis.buffers()) {
@@ -380,21 +424,27 @@ class MaterializeBuffers
       // Insert loads and stores.
       for (auto [op, pos] : buffer.reads()) {
         auto compute_op = cast<ComputeOp>(op.GetDuplicatedOp());
-        InsertLoad(compute_op, pos, buffer, memref, fusion_analysis,
-                   iteration_spaces, storage_analysis, sequence_analysis,
-                   builder);
+        // Only prefetch from external buffers as these hold the large inputs
+        // streamed by the program.
+        InsertLoad(compute_op, pos, buffer, memref,
+                   /*prefetch=*/prefetch && buffer.is_external(),
+                   fusion_analysis, iteration_spaces, storage_analysis,
+                   sequence_analysis, builder);
       }
+      bool nontemporal = nontemporal_buffers.contains(&buffer);
       for (auto [op, pos] : buffer.writes()) {
         auto compute_op = cast<ComputeOp>(op.GetDuplicatedOp());
-        InsertStore(compute_op, pos, buffer, memref, fusion_analysis,
-                    iteration_spaces, storage_analysis, sequence_analysis,
-                    builder);
+        InsertStore(compute_op, pos, buffer, memref, nontemporal,
+                    fusion_analysis, iteration_spaces, storage_analysis,
+                    sequence_analysis, builder);
       }
 
       // Erase ToMemRefOp as it has side effects and wont be considered by
       // DCE.
       if (buffer.is_external() &&
           isa<SairToMemRefOp>(buffer.import_op().getOperation())) {
+        auto import_op = cast<SairOp>(buffer.import_op().getOperation());
+        iteration_spaces.Invalidate(OpInstance::Unique(import_op));
         buffer.import_op()->erase();
       }
 
@@ -407,6 +457,7 @@ class MaterializeBuffers
           continue;
         }
 
+        iteration_spaces.Invalidate(OpInstance::Unique(cast<SairOp>(op)));
         op->dropAllDefinedValueUses();
         op->erase();
       }
@@ -416,10 +467,13 @@ class MaterializeBuffers
   }
 
   void runOnOperation() override {
-    markAnalysesPreserved<LoopFusionAnalysis, IterationSpaceAnalysis>();
+    // Iteration spaces of erased operations are invalidated and those of new
+    // operations computed on demand. Loop fusion classes do not know about the
+    // operations inserted in loops, so they are recomputed.
+    markAnalysesPreserved<IterationSpaceAnalysis>();
 
     auto result = getOperation().walk([&](SairOp op) -> mlir::WalkResult {
-      auto storage_analysis =
+      auto &storage_analysis =
           getChildAnalysis<StorageAnalysis>(op->getParentOp());
       if (!op.HasExactlyOneInstance()) {
         return op.emitError() << "operations must have exactly one instance "
@@ -41,7 +41,7 @@ void CreateRange(const IterationSpaceAnalysis &iter_spaces, SairOp op,
                  llvm::ArrayRef<mlir::Attribute> new_loop_nest,
                  SequenceAnalysis &sequence_analysis,
                  llvm::SmallVectorImpl<mlir::Value> &new_domain,
-                 mlir::OpBuilder &builder) {
+                 mlir::OpBuilder &builder, RangeCache &range_cache) {
   mlir::OpBuilder::InsertionGuard guard(builder);
   mlir::MLIRContext *context = op.getContext();
 
@@ -67,7 +67,7 @@ void CreateRange(const IterationSpaceAnalysis &iter_spaces, SairOp op,
   // Create a sair.map operation with `block` as body and add a sair.return
   // operation to `block`. Create a range operation that uses the bounds
   // returned by the sair.map operations. If range parameters are constants and
-  // range lower bound is zero, delete the block and create a static range
+  // range lower bound is zero, delete the block and use a static range
   // instead.
   mlir::Value range;
   bool is_beg_zero = range_parameters.begin.is<mlir::Attribute>() &&
@@ -79,9 +79,8 @@ void CreateRange(const IterationSpaceAnalysis &iter_spaces, SairOp op,
   if (range_parameters.end.is<mlir::Attribute>() && is_beg_zero) {
     assert(range_rank == 0);
     builder.setInsertionPoint(op);
-    range = builder.create<SairStaticRangeOp>(
-        op.getLoc(), loop_shape.type(),
-        /*instances=*/GetInstanceZeroOperandsSingleInstance(context, 0));
+    range = range_cache.GetOrCreateStaticRange(
+        op.getLoc(), loop_shape.type().cast<StaticRangeType>(), builder);
   } else {
     llvm::SmallVector<mlir::Value> scalar_results;
     if (!is_beg_zero) {
@@ -147,32 +146,28 @@ void CreateRange(const IterationSpaceAnalysis &iter_spaces, SairOp op,
   new_domain.push_back(range);
 }
 
-// Caches loop ranges. Indexed by loop name.
-using LoopRangeCache = llvm::DenseMap<mlir::Attribute, mlir::Value>;
-
 // Create a domain for `op` where each dimension corresponds to a single loop.
 llvm::SmallVector<mlir::Value> GetDomain(
     const IterationSpaceAnalysis &iter_spaces, SairOp op,
     llvm::ArrayRef<mlir::StringAttr> loop_names, const LoopNest &loop_nest,
     DomainShapeAttr shape, SequenceAnalysis &sequence_analysis,
     llvm::ArrayRef<mlir::Attribute> normalized_loops, mlir::OpBuilder &builder,
-    LoopRangeCache &loop_range_cache) {
+    RangeCache &range_cache) {
   MappingAttr inverse_mapping = loop_nest.DomainToLoops().Inverse();
 
   llvm::SmallVector<mlir::Value> new_domain;
   new_domain.reserve(loop_names.size());
 
   for (int i = 0, e = loop_names.size(); i < e; ++i) {
-    auto cache = loop_range_cache.find(loop_names[i]);
-    if (cache != loop_range_cache.end()) {
-      new_domain.push_back(cache->second);
+    if (mlir::Value range = range_cache.GetLoopRange(loop_names[i])) {
+      new_domain.push_back(range);
       continue;
     }
 
     CreateRange(iter_spaces, op, loop_nest, i, shape.Dimension(i),
                 inverse_mapping, normalized_loops, sequence_analysis,
-                new_domain, builder);
-    loop_range_cache.try_emplace(loop_names[i], new_domain.back());
+                new_domain, builder, range_cache);
+    range_cache.AddLoopRange(loop_names[i], new_domain.back());
   }
 
   return new_domain;
@@ -237,8 +232,7 @@ void NormalizeLoops(SairOp op, const IterationSpace &iteration_space,
                     const LoopFusionAnalysis &fusion_analysis,
                     const IterationSpaceAnalysis &iter_spaces,
                     SequenceAnalysis &sequence_analysis,
-                    mlir::OpBuilder &builder,
-                    LoopRangeCache &loop_range_cache) {
+                    mlir::OpBuilder &builder, RangeCache &range_cache) {
   if (iteration_space.num_loops() == 0) return;
   mlir::OpBuilder::InsertionGuard insertion_guard(builder);
   mlir::MLIRContext *context = op.getContext();
@@ -249,16 +243,16 @@ void NormalizeLoops(SairOp op, const IterationSpace &iteration_space,
   for (int i = 0, e = iteration_space.num_loops(); i < e; ++i) {
     auto dim_expr = MappingDimExpr::get(i, context);
     mlir::StringAttr name = iteration_space.loop_names()[i];
-    mlir::IntegerAttr unroll_attr =
-        fusion_analysis.GetClass(name).GetUnrollAttr(*builder.getContext());
-    normalized_loops.push_back(
-        LoopAttr::get(name, dim_expr, unroll_attr, context));
+    const LoopFusionClass &fusion_class = fusion_analysis.GetClass(name);
+    normalized_loops.push_back(LoopAttr::get(
+        name, dim_expr, fusion_class.GetUnrollAttr(*context),
+        fusion_class.GetUnrollAndJamAttr(*context), context));
   }
 
   MappingAttr mapping = iteration_space.MappingToLoops();
   llvm::SmallVector<mlir::Value> new_domain = GetDomain(
       iter_spaces, op, iteration_space.loop_names(), loop_nest, new_shape,
-      sequence_analysis, normalized_loops, builder, loop_range_cache);
+      sequence_analysis, normalized_loops, builder, range_cache);
   llvm::SmallVector<llvm::SmallVector<mlir::Value>> partitioned_domain =
       PartitionDomain(op, mapping, new_shape, new_domain);
 
@@ -332,10 +326,12 @@ class NormalizeLoopsPass
  public:
   mlir::LogicalResult RunOpProgram(SairProgramOp program,
                                    mlir::OpBuilder &builder) {
-    LoopRangeCache loop_range_cache;
-    auto iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
-    auto fusion_analysis = getChildAnalysis<LoopFusionAnalysis>(program);
-    auto sequence_analysis = getChildAnalysis<SequenceAnalysis>(program);
+    RangeCache range_cache(program);
+    auto &iteration_spaces = getChildAnalysis<IterationSpaceAnalysis>(program);
+    // Operations are rewritten while the analysis is queried.
+    iteration_spaces.ComputeAll(program);
+    auto &fusion_analysis = getChildAnalysis<LoopFusionAnalysis>(program);
+    auto &sequence_analysis = getChildAnalysis<SequenceAnalysis>(program);
 
     llvm::SmallVector<SairOp> ops;
     program.walk([&](SairOp op) {
@@ -374,7 +370,7 @@ class NormalizeLoopsPass
           fusion_analysis.GetLoopNest(iteration_space.loop_names());
       NormalizeLoops(op, iteration_space, loop_nest, fusion_analysis,
                      iteration_spaces, sequence_analysis, builder,
-                     loop_range_cache);
+                     range_cache);
     }
 
     sequence_analysis.AssignInferred();
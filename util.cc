@@ -14,6 +14,9 @@
 
 #include "util.h"
 
+#include <algorithm>
+#include <optional>
+
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
@@ -26,6 +29,16 @@
 namespace sair {
 namespace {
 
+// Returns `end - begin` if both are constants.
+std::optional<int> ConstantExtent(mlir::OpFoldResult begin,
+                                  mlir::OpFoldResult end) {
+  if (!begin.is<mlir::Attribute>() || !end.is<mlir::Attribute>()) {
+    return std::nullopt;
+  }
+  return end.get<mlir::Attribute>().cast<mlir::IntegerAttr>().getInt() -
+         begin.get<mlir::Attribute>().cast<mlir::IntegerAttr>().getInt();
+}
+
 // Helper class to build range parameters.
 class RangeParameterBuilder {
  public:
@@ -93,9 +106,12 @@ RangeParameters RangeParameterBuilder::Get(MappingDimExpr expr) {
       dimension.mapping.ResizeUseDomain(current_to_source_.size()));
   assert(mapping.IsSurjective());
 
-  return {.begin = AddArgument(range_op.LowerBound().Map(mapping)),
-          .end = AddArgument(range_op.UpperBound().Map(mapping)),
-          .step = range_op.Step()};
+  mlir::OpFoldResult begin = AddArgument(range_op.LowerBound().Map(mapping));
+  mlir::OpFoldResult end = AddArgument(range_op.UpperBound().Map(mapping));
+  return {.begin = begin,
+          .end = end,
+          .step = range_op.Step(),
+          .max_extent = ConstantExtent(begin, end)};
 }
 
 RangeParameters RangeParameterBuilder::Get(MappingStripeExpr expr) {
@@ -106,9 +122,15 @@ RangeParameters RangeParameterBuilder::Get(MappingStripeExpr expr) {
   // If the stripe covers the entire operand range, no additional
   // computation is needed.
   if (expr.factors().size() == 1) {
-    return {operand_parameters.begin, operand_parameters.end, step};
+    return {operand_parameters.begin, operand_parameters.end, step,
+            operand_parameters.max_extent};
   }
   int size = expr.factors()[expr.factors().size() - 2];
+  int extent = size * operand_parameters.step;
+  std::optional<int> max_extent = extent;
+  if (operand_parameters.max_extent.has_value()) {
+    max_extent = std::min(extent, *operand_parameters.max_extent);
+  }
 
   // Compute the begin index. For this, look for the unstripe operation
   // corresponding to `this` in the inverse mapping, and find the
@@ -125,9 +147,18 @@ RangeParameters RangeParameterBuilder::Get(MappingStripeExpr expr) {
   // Compute the end index as `min(begin + size, operand_size)`.
   mlir::Type index_type = builder_.getIndexType();
   auto size_op = builder_.create<mlir::arith::ConstantOp>(
-      loc_, index_type, builder_.getIndexAttr(size * operand_parameters.step));
-  auto uncapped_end =
+      loc_, index_type, builder_.getIndexAttr(extent));
+  mlir::Value uncapped_end =
       builder_.create<mlir::arith::AddIOp>(loc_, index_type, begin, size_op);
+
+  // If the operand range is statically a whole number of stripes, the end index
+  // never needs to be capped and the stripe has a constant trip count.
+  std::optional<int> operand_extent =
+      ConstantExtent(operand_parameters.begin, operand_parameters.end);
+  if (operand_extent.has_value() && *operand_extent % extent == 0) {
+    return {begin, uncapped_end, step, extent};
+  }
+
   mlir::Value operand_end;
   if (operand_parameters.end.is<mlir::Attribute>()) {
     operand_end = builder_.create<mlir::arith::ConstantOp>(
@@ -140,7 +171,7 @@ RangeParameters RangeParameterBuilder::Get(MappingStripeExpr expr) {
   mlir::Value end = builder_.create<mlir::arith::SelectOp>(
       loc_, builder_.getIndexType(), is_capped, operand_end, uncapped_end);
 
-  return {begin, end, step};
+  return {begin, end, step, max_extent};
 }
 
 RangeParameters RangeParameterBuilder::Get(MappingUnStripeExpr expr) {
@@ -15,6 +15,8 @@
 #ifndef THIRD_PARTY_SAIR_TRANSFORMS_UTIL_H_
 #define THIRD_PARTY_SAIR_TRANSFORMS_UTIL_H_
 
+#include <optional>
+
 #include "mlir/IR/Builders.h"
 #include "sair_attributes.h"
 #include "sair_op_interfaces.h"
@@ -80,6 +82,9 @@ struct RangeParameters {
   mlir::OpFoldResult end;
   // Step of the range.
   int step;
+  // Static upper bound of `end - begin`, if known. The bound holds even when
+  // `begin` and `end` are values, for example for the inner loop of a stripe.
+  std::optional<int> max_extent = std::nullopt;
 };
 
 // Returns a function that applies a function to each element of an array